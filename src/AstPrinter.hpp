@@ -6,92 +6,93 @@
 
 namespace zebra {
 
-    class AstPrinter: public ExprStringVisitor {
+    class AstPrinter {
+        friend struct ExprDispatch;
         public:
             AstPrinter() {}
             ~AstPrinter() {}
-            void print(std::vector<std::shared_ptr<Expr>> ast) {
-                for (std::shared_ptr<Expr> expr: ast) {
-                    std::cout << to_string(expr.get()) << std::endl;
+            void print(const std::vector<Expr*>& ast) {
+                for (Expr* expr: ast) {
+                    std::cout << to_string(expr) << std::endl;
                 }
 
             }
         private:
             std::string to_string(Expr* expr) {
-                return expr->accept(*this); 
+                return ExprDispatch::visit(*this, expr);
             }
 
 
             /*
              * Basic
              */
-            std::string visit(Unary* expr) override {
-                return "( " + expr->m_op.to_string() + " " + expr->m_right->accept(*this);
+            std::string visit(Unary* expr) {
+                return "( " + expr->m_op.to_string() + " " + to_string(expr->m_right);
             }
-            std::string visit(Binary* expr) override {
-                return "( " + expr->m_op.to_string() + " " + expr->m_left->accept(*this) + " " + expr->m_right->accept(*this) + " )";
+            std::string visit(Binary* expr) {
+                return "( " + expr->m_op.to_string() + " " + to_string(expr->m_left) + " " + to_string(expr->m_right) + " )";
             }
-            std::string visit(Group* expr) override {
-                return "( " + expr->m_expr->accept(*this) + " )";
+            std::string visit(Group* expr) {
+                return "( " + to_string(expr->m_expr) + " )";
             }
-            std::string visit(Literal* expr) override {
+            std::string visit(Literal* expr) {
                 return "( " + expr->m_token.to_string() + " )";
             }
-            std::string visit(Logic* expr) override {
-                return "( " + expr->m_op.to_string() + " " + expr->m_left->accept(*this) + " " + expr->m_right->accept(*this) + " )";
+            std::string visit(Logic* expr) {
+                return "( " + expr->m_op.to_string() + " " + to_string(expr->m_left) + " " + to_string(expr->m_right) + " )";
             }
 
             /*
              * Variables and Functions
              */
-            std::string visit(GetVar* expr) override {
+            std::string visit(GetVar* expr) {
                 return "( " + expr->m_name.to_string() + " )";
             }
-            std::string visit(DeclVar* expr) override {
-                return "( DeclVar " + expr->m_value->accept(*this) + " )";
+            std::string visit(DeclVar* expr) {
+                return "( DeclVar " + to_string(expr->m_value) + " )";
             }
-            std::string visit(SetVar* expr) override {
+            std::string visit(SetVar* expr) {
                 return "SetVar";
             }
-            std::string visit(DeclFun* expr) override {
+            std::string visit(DeclFun* expr) {
                 return "FunDecl";
             }
-            std::string visit(CallFun* expr) override {
+            std::string visit(CallFun* expr) {
                 return "CallFun";
             }
-            std::string visit(Return* expr) override {
+            std::string visit(Return* expr) {
                 return "Return";
             }
 
             /*
              * Control Flow
              */
-            std::string visit(Block* expr) override {
+            std::string visit(Block* expr) {
                 std::string ret = "( Block ";
-                for(std::shared_ptr<Expr> e: expr->m_expressions) {
-                    ret += e->accept(*this) + ", ";
+                for(Expr* e: expr->m_expressions) {
+                    ret += to_string(e) + ", ";
                 }
                 return ret + " )";
             }
-            std::string visit(If* expr) override {
-                std::string ret = "( If " + to_string(expr->m_condition.get()) + " then " + to_string(expr->m_then_branch.get());
+            std::string visit(If* expr) {
+                std::string ret = "( If " + to_string(expr->m_condition) + " then " + to_string(expr->m_then_branch);
                 if (expr->m_else_branch) {
-                    ret += " else " + to_string(expr->m_else_branch.get());
+                    ret += " else " + to_string(expr->m_else_branch);
                 }
 
                 return ret + " )";
             }
-            std::string visit(For* expr) override {
+            std::string visit(For* expr) {
                 return "( For )";
             }
-            std::string visit(While* expr) override {
+            std::string visit(While* expr) {
                 return "While";
             }
             
             /*
              * Classes
              */
-            std::string visit(DeclClass* expr) override {
+            std::string visit(DeclClass* expr) {
                 return "ClassDecl";
             }
 
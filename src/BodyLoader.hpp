@@ -0,0 +1,183 @@
+#ifndef ZEBRA_BODY_LOADER_H
+#define ZEBRA_BODY_LOADER_H
+
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+
+#include "Expr.hpp"
+#include "Lexer.hpp"
+#include "Parser.hpp"
+#include "ResultCode.hpp"
+
+namespace zebra {
+
+    /*
+     * Parses the top-level function bodies the Parser skipped, but only for functions named
+     * somewhere in code that is itself parsed: top-level statements, class methods and bodies
+     * already loaded.  Bodies of functions nobody names are left empty, so they are never
+     * resolved, type checked or compiled.  Runs between the Parser and the Resolver.
+     */
+    class BodyLoader {
+        friend struct ExprDispatch;
+        private:
+            Lexer& m_lexer;
+            AstArena& m_arena;
+            std::unordered_map<int, std::vector<DeclFun*>> m_skipped; //by function name
+            std::vector<DeclFun*> m_named; //skipped bodies waiting to be parsed
+            std::vector<ParseError> m_errors;
+        public:
+            BodyLoader(Lexer& lexer, AstArena& arena): m_lexer(lexer), m_arena(arena) {}
+            ~BodyLoader() {}
+
+            ResultCode load(const std::vector<Expr*>& ast) {
+                for (Expr* expr: ast) {
+                    DeclFun* decl = expr_cast<DeclFun>(expr);
+                    if (decl && !decl->m_body) {
+                        m_skipped[decl->m_name.m_symbol].push_back(decl);
+                    }
+                }
+
+                for (Expr* expr: ast) {
+                    walk(expr);
+                }
+
+                while (!m_named.empty()) {
+                    DeclFun* decl = m_named.back();
+                    m_named.pop_back();
+                    parse_body(decl);
+                    walk(decl->m_body);
+                }
+
+                for (const std::pair<const int, std::vector<DeclFun*>>& p: m_skipped) {
+                    for (DeclFun* decl: p.second) {
+                        decl->m_body = m_arena.make<Block>(decl->m_body_start, ExprList());
+                    }
+                }
+
+                //bodies are parsed in the order they are first named, not in source order
+                std::stable_sort(m_errors.begin(), m_errors.end(), [](const ParseError& a, const ParseError& b) {
+                    return a.m_token.m_line < b.m_token.m_line;
+                });
+
+                if (m_errors.empty()) {
+                    return ResultCode::SUCCESS;
+                } else {
+                    return ResultCode::FAILED;
+                }
+            }
+
+            std::vector<ParseError> get_errors() const {
+                return m_errors;
+            }
+
+        private:
+            //scanning restarts just past the '{'; the body was already scanned once while it was
+            //skipped, so any syntax errors in it have been reported by the script's Lexer
+            void parse_body(DeclFun* decl) {
+                size_t begin = size_t(decl->m_body_start.m_start - m_lexer.source().data());
+                Lexer lexer(m_lexer, begin, m_lexer.source().size(), decl->m_body_start.m_line);
+                Parser parser(lexer, m_arena);
+                if (parser.parse_body(decl) != ResultCode::SUCCESS) {
+                    std::vector<ParseError> errors = parser.get_errors();
+                    m_errors.insert(m_errors.end(), errors.begin(), errors.end());
+                }
+            }
+
+            void name_used(const Token& name) {
+                auto it = m_skipped.find(name.m_symbol);
+                if (it == m_skipped.end()) return;
+
+                m_named.insert(m_named.end(), it->second.begin(), it->second.end());
+                m_skipped.erase(it);
+            }
+
+            //children may be null where the Parser reported an error
+            void walk(Expr* expr) {
+                if (expr) ExprDispatch::visit(*this, expr);
+            }
+
+            void walk(ExprList list) {
+                for (Expr* e: list) {
+                    walk(e);
+                }
+            }
+
+            /*
+             * Basic
+             */
+            void visit(Unary* expr) {
+                walk(expr->m_right);
+            }
+            void visit(Binary* expr) {
+                walk(expr->m_left);
+                walk(expr->m_right);
+            }
+            void visit(Group* expr) {
+                walk(expr->m_expr);
+            }
+            void visit(Literal*) {}
+            void visit(Logic* expr) {
+                walk(expr->m_left);
+                walk(expr->m_right);
+            }
+
+            /*
+             * Variables and Functions
+             */
+            void visit(DeclVar* expr) {
+                walk(expr->m_value);
+            }
+            //functions can be passed around by name as well as called
+            void visit(GetVar* expr) {
+                if (expr->m_env.m_type == TokenType::NIL) name_used(expr->m_name);
+            }
+            void visit(SetVar* expr) {
+                walk(expr->m_value);
+            }
+            void visit(DeclFun* expr) {
+                walk(expr->m_body);
+            }
+            void visit(CallFun* expr) {
+                if (expr->m_env.m_type == TokenType::NIL) name_used(expr->m_name);
+                walk(expr->m_arguments);
+            }
+            void visit(Return* expr) {
+                walk(expr->m_value);
+            }
+
+            /*
+             * Control Flow
+             */
+            void visit(Block* expr) {
+                walk(expr->m_expressions);
+            }
+            void visit(If* expr) {
+                walk(expr->m_condition);
+                walk(expr->m_then_branch);
+                walk(expr->m_else_branch);
+            }
+            void visit(For* expr) {
+                walk(expr->m_initializer);
+                walk(expr->m_condition);
+                walk(expr->m_update);
+                walk(expr->m_body);
+            }
+            void visit(While* expr) {
+                walk(expr->m_condition);
+                walk(expr->m_body);
+            }
+
+            /*
+             * Classes
+             */
+            void visit(DeclClass* expr) {
+                walk(expr->m_fields);
+                walk(expr->m_methods);
+            }
+    };
+
+}
+
+
+#endif // ZEBRA_BODY_LOADER_H
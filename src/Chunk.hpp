@@ -0,0 +1,132 @@
+#ifndef ZEBRA_CHUNK_H
+#define ZEBRA_CHUNK_H
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include "Token.hpp"
+#include "Value.hpp"
+#include "InlineCache.hpp"
+
+namespace zebra {
+
+    /*
+     * Operands are encoded inline after the opcode as 16-bit values (high byte first)
+     */
+    enum class OpCode: uint8_t {
+        //constants
+        CONSTANT,               //[constant]
+        NIL, TRUE, FALSE,
+        POP,
+        //arithmetic - operand types are known from the Typer, so each type gets its own opcode
+        ADD_INT, SUBTRACT_INT, MULTIPLY_INT, DIVIDE_INT, MOD_INT, NEGATE_INT,
+        ADD_FLOAT, SUBTRACT_FLOAT, MULTIPLY_FLOAT, DIVIDE_FLOAT, NEGATE_FLOAT,
+        CONCAT,
+        NOT,
+        //comparison - and / or compile to jumps so the right side can be skipped
+        EQUAL_INT, NOT_EQUAL_INT, LESS_INT, LESS_EQUAL_INT, GREATER_INT, GREATER_EQUAL_INT,
+        EQUAL_FLOAT, NOT_EQUAL_FLOAT, LESS_FLOAT, LESS_EQUAL_FLOAT, GREATER_FLOAT, GREATER_EQUAL_FLOAT,
+        EQUAL_BOOL, NOT_EQUAL_BOOL,
+        EQUAL_STRING, NOT_EQUAL_STRING,
+        //variables
+        DEFINE_VAR,             //[slot]
+        GET_VAR,                //[depth] [slot]
+        SET_VAR,                //[depth] [slot]
+        INCREMENT_INT,          //[depth] [slot] [constant] - x = x + c as a statement
+        GET_FIELD,              //[instance depth] [instance slot] [field name] [cache]
+        SET_FIELD,              //[instance depth] [instance slot] [field name] [cache]
+        PUSH_SCOPE,             //[slot count]
+        POP_SCOPE,
+        //control flow
+        JUMP,                   //[forward offset]
+        JUMP_IF_FALSE,          //[forward offset]
+        LOOP,                   //[backward offset]
+        //functions and classes
+        CALL,                   //[depth] [slot] [argument count]
+        INVOKE,                 //[instance depth] [instance slot] [method name] [cache] [argument count]
+        RETURN,
+        CLASS                   //[slot] [base depth] [base slot or NO_OPERAND] [field count] [field names...]
+                                //[method count] [method name, method constant]...
+    };
+
+    struct Chunk {
+        public:
+            static const uint16_t NO_OPERAND = 0xffff;
+            std::vector<uint8_t> m_code;
+            std::vector<int> m_lines;
+            std::vector<Value> m_constants;
+            std::vector<Token> m_names;
+            std::vector<InlineCache> m_caches; //one per field access and method call site
+        private:
+            std::unordered_map<int, int> m_name_index;
+            std::unordered_map<int, int> m_int_index;
+            std::unordered_map<uint32_t, int> m_float_index; //by bit pattern, so -0.0 keeps its own constant
+            std::unordered_map<std::string, int> m_string_index;
+        public:
+            void write(uint8_t byte, int line) {
+                m_code.push_back(byte);
+                m_lines.push_back(line);
+            }
+
+            void write_op(OpCode op, int line) {
+                write(uint8_t(op), line);
+            }
+
+            void write_short(uint16_t value, int line) {
+                write(uint8_t(value >> 8), line);
+                write(uint8_t(value & 0xff), line);
+            }
+
+            void patch_short(int offset, uint16_t value) {
+                m_code.at(offset) = uint8_t(value >> 8);
+                m_code.at(offset + 1) = uint8_t(value & 0xff);
+            }
+
+            //equal literals share a constant, which keeps operands within 16 bits for longer
+            int add_constant(const Value& value) {
+                if (value.is_int()) return index_of(m_int_index, value.m_int, value);
+                if (value.is_float()) {
+                    uint32_t bits;
+                    std::memcpy(&bits, &value.m_float, sizeof(bits));
+                    return index_of(m_float_index, bits, value);
+                }
+                if (value.is_string()) return index_of(m_string_index, value.as_string(), value);
+
+                m_constants.push_back(value);
+                return int(m_constants.size()) - 1;
+            }
+
+            int add_cache() {
+                m_caches.emplace_back();
+                return int(m_caches.size()) - 1;
+            }
+
+            //identifiers are shared by every instruction that refers to them
+            int add_name(const Token& name) {
+                auto it = m_name_index.find(name.m_symbol);
+                if (it != m_name_index.end()) return it->second;
+
+                m_names.push_back(name);
+                m_name_index[name.m_symbol] = int(m_names.size()) - 1;
+                return int(m_names.size()) - 1;
+            }
+
+        private:
+            template <typename K>
+            int index_of(std::unordered_map<K, int>& index, const K& key, const Value& value) {
+                auto it = index.find(key);
+                if (it != index.end()) return it->second;
+
+                m_constants.push_back(value);
+                index.emplace(key, int(m_constants.size()) - 1);
+                return int(m_constants.size()) - 1;
+            }
+    };
+
+}
+
+
+#endif // ZEBRA_CHUNK_H
@@ -0,0 +1,550 @@
+#ifndef ZEBRA_COMPILER_H
+#define ZEBRA_COMPILER_H
+
+#include <vector>
+#include <iostream>
+#include "Token.hpp"
+#include "Expr.hpp"
+#include "Chunk.hpp"
+#include "Object.hpp"
+#include "ResultCode.hpp"
+
+namespace zebra {
+
+    struct CompileError {
+        Token m_token;
+        std::string m_message;
+        CompileError(Token token, const std::string& message): m_token(token), m_message(message) {}
+        void print(std::ostream& out = std::cout) {
+            out << "[Line " << m_token.m_line << "] Compile Error: " << m_message << std::endl;
+        }
+    };
+
+
+    /*
+     * Lowers the AST to bytecode.  Every expression leaves exactly one value on the VM stack.
+     * Anything in statement position goes through exec() instead: expressions are
+     * followed by a POP, while control flow leaves nothing behind.
+     */
+    class Compiler {
+        friend struct ExprDispatch;
+        private:
+            std::shared_ptr<Chunk> m_chunk;
+            std::vector<CompileError> m_errors;
+            bool m_over_limit {false};
+        public:
+            Compiler() {}
+            ~Compiler() {}
+
+            ResultCode compile(const std::vector<Expr*>& ast, std::shared_ptr<Chunk>& chunk) {
+                m_chunk = std::make_shared<Chunk>();
+                int line = 0;
+                for (Expr* expr: ast) {
+                    compile_statement(expr);
+                }
+                emit_op(OpCode::NIL, line);
+                emit_op(OpCode::RETURN, line);
+
+                chunk = m_chunk;
+
+                if (m_errors.empty()) {
+                    return ResultCode::SUCCESS;
+                } else {
+                    return ResultCode::FAILED;
+                }
+            }
+
+            std::vector<CompileError> get_errors() const {
+                return m_errors;
+            }
+
+            //an operand didn't fit in 16 bits; the program is valid, only too large for this chunk format
+            bool over_limit() const {
+                return m_over_limit;
+            }
+
+        private:
+            void compile(Expr* expr) {
+                ExprDispatch::visit(*this, expr);
+            }
+
+            Completion compile_statement(Expr* expr) {
+                return ExprDispatch::exec(*this, expr);
+            }
+
+            //statements following a return in the same block can never run, so they are not emitted
+            void compile_statements(ExprList statements) {
+                for (Expr* e: statements) {
+                    if (compile_statement(e) == Completion::RETURN) {
+                        break;
+                    }
+                }
+            }
+
+            void add_error(Token token, const std::string& message) {
+                m_errors.emplace_back(token, message);
+            }
+
+            void add_limit_error(Token token, const std::string& message) {
+                add_error(token, message);
+                m_over_limit = true;
+            }
+
+            void emit_op(OpCode op, int line) {
+                m_chunk->write_op(op, line);
+            }
+
+            void emit_short(int value, const Token& token) {
+                if (value > Chunk::NO_OPERAND - 1) {
+                    add_limit_error(token, "Too many constants, names or arguments in one chunk.");
+                }
+                m_chunk->write_short(uint16_t(value), token.m_line);
+            }
+
+            void emit_constant(const Value& value, const Token& token) {
+                emit_op(OpCode::CONSTANT, token.m_line);
+                emit_short(m_chunk->add_constant(value), token);
+            }
+
+            void emit_name(const Token& name) {
+                emit_short(m_chunk->add_name(name), name);
+            }
+
+            //returns offset of operand to patch once the jump target is known
+            int emit_jump(OpCode op, const Token& token) {
+                emit_op(op, token.m_line);
+                m_chunk->write_short(0, token.m_line);
+                return int(m_chunk->m_code.size()) - 2;
+            }
+
+            void patch_jump(int offset, const Token& token) {
+                int distance = int(m_chunk->m_code.size()) - offset - 2;
+                if (distance > Chunk::NO_OPERAND) {
+                    add_limit_error(token, "Too much code to jump over.");
+                }
+                m_chunk->patch_short(offset, uint16_t(distance));
+            }
+
+            void emit_loop(int loop_start, const Token& token) {
+                emit_op(OpCode::LOOP, token.m_line);
+                int distance = int(m_chunk->m_code.size()) - loop_start + 2;
+                if (distance > Chunk::NO_OPERAND) {
+                    add_limit_error(token, "Loop body too large.");
+                }
+                m_chunk->write_short(uint16_t(distance), token.m_line);
+            }
+
+            std::shared_ptr<FunDef> compile_function(DeclFun* decl) {
+                std::shared_ptr<Chunk> enclosing = m_chunk;
+                m_chunk = std::make_shared<Chunk>();
+
+                //body shares the frame the VM creates for the call, so no scope is pushed
+                compile_statements(expr_cast<Block>(decl->m_body)->m_expressions);
+
+                //functions without an explicit return give back nil
+                emit_op(OpCode::NIL, decl->m_name.m_line);
+                emit_op(OpCode::RETURN, decl->m_name.m_line);
+
+                std::shared_ptr<FunDef> fun = std::make_shared<FunDef>(decl->m_parameters, decl->m_body, decl->m_slot_count, m_chunk);
+                m_chunk = enclosing;
+                return fun;
+            }
+
+            //loop counters and the accumulators the Optimizer adds are stepped with a single instruction
+            bool compile_increment(SetVar* expr) {
+                Binary* sum = expr_cast<Binary>(expr->m_value);
+                if (expr->m_env.m_type != TokenType::NIL || !sum || sum->m_op.m_type != TokenType::PLUS ||
+                    sum->m_data_type.m_type != TokenType::INT_TYPE) {
+                    return false;
+                }
+
+                GetVar* var = expr_cast<GetVar>(sum->m_left);
+                Literal* step = expr_cast<Literal>(sum->m_right);
+                if (!var || !step || var->m_env.m_type != TokenType::NIL ||
+                    var->m_depth != expr->m_depth || var->m_slot != expr->m_slot) {
+                    return false;
+                }
+
+                emit_op(OpCode::INCREMENT_INT, expr->m_name.m_line);
+                emit_short(expr->m_depth, expr->m_name);
+                emit_short(expr->m_slot, expr->m_name);
+                emit_short(m_chunk->add_constant(step->m_value), step->m_token);
+                return true;
+            }
+
+            //right side is skipped when the left side already decides the result
+            void compile_short_circuit(Logic* expr) {
+                bool is_and = expr->m_op.m_type == TokenType::AND;
+                int line = expr->m_op.m_line;
+
+                compile(expr->m_left);
+                int false_jump = emit_jump(OpCode::JUMP_IF_FALSE, expr->m_op);
+
+                if (is_and) {
+                    compile(expr->m_right);
+                } else {
+                    emit_op(OpCode::TRUE, line);
+                }
+                int end_jump = emit_jump(OpCode::JUMP, expr->m_op);
+
+                patch_jump(false_jump, expr->m_op);
+                if (is_and) {
+                    emit_op(OpCode::FALSE, line);
+                } else {
+                    compile(expr->m_right);
+                }
+                patch_jump(end_jump, expr->m_op);
+            }
+
+            /*
+             * Basic
+             */
+            void visit(Unary* expr) {
+                compile(expr->m_right);
+                int line = expr->m_op.m_line;
+                switch(expr->m_data_type.m_type) {
+                    case TokenType::INT_TYPE: emit_op(OpCode::NEGATE_INT, line); break;
+                    case TokenType::FLOAT_TYPE: emit_op(OpCode::NEGATE_FLOAT, line); break;
+                    case TokenType::BOOL_TYPE: emit_op(OpCode::NOT, line); break;
+                    default: add_error(expr->m_op, "Invalid unary operator."); break;
+                }
+            }
+
+            void visit(Binary* expr) {
+                compile(expr->m_left);
+                compile(expr->m_right);
+                int line = expr->m_op.m_line;
+                TokenType type = expr->m_data_type.m_type;
+                if (type == TokenType::INT_TYPE) {
+                    switch(expr->m_op.m_type) {
+                        case TokenType::PLUS: emit_op(OpCode::ADD_INT, line); return;
+                        case TokenType::MINUS: emit_op(OpCode::SUBTRACT_INT, line); return;
+                        case TokenType::STAR: emit_op(OpCode::MULTIPLY_INT, line); return;
+                        case TokenType::SLASH: emit_op(OpCode::DIVIDE_INT, line); return;
+                        case TokenType::MOD: emit_op(OpCode::MOD_INT, line); return;
+                        default: break;
+                    }
+                } else if (type == TokenType::FLOAT_TYPE) {
+                    switch(expr->m_op.m_type) {
+                        case TokenType::PLUS: emit_op(OpCode::ADD_FLOAT, line); return;
+                        case TokenType::MINUS: emit_op(OpCode::SUBTRACT_FLOAT, line); return;
+                        case TokenType::STAR: emit_op(OpCode::MULTIPLY_FLOAT, line); return;
+                        case TokenType::SLASH: emit_op(OpCode::DIVIDE_FLOAT, line); return;
+                        default: break;
+                    }
+                } else if (type == TokenType::STRING_TYPE && expr->m_op.m_type == TokenType::PLUS) {
+                    emit_op(OpCode::CONCAT, line);
+                    return;
+                }
+                add_error(expr->m_op, "Invalid binary operator.");
+            }
+
+            void visit(Group* expr) {
+                compile(expr->m_expr);
+            }
+
+            void visit(Literal* expr) {
+                switch(expr->m_token.m_type) {
+                    case TokenType::FLOAT:
+                    case TokenType::INT:
+                    case TokenType::STRING:
+                        emit_constant(expr->m_value, expr->m_token);
+                        break;
+                    case TokenType::TRUE: emit_op(OpCode::TRUE, expr->m_token.m_line); break;
+                    case TokenType::FALSE: emit_op(OpCode::FALSE, expr->m_token.m_line); break;
+                    default: emit_op(OpCode::NIL, expr->m_token.m_line); break;
+                }
+            }
+
+            void visit(Logic* expr) {
+                if (expr->m_op.m_type == TokenType::AND || expr->m_op.m_type == TokenType::OR) {
+                    compile_short_circuit(expr);
+                    return;
+                }
+
+                compile(expr->m_left);
+                compile(expr->m_right);
+                int line = expr->m_op.m_line;
+                switch(expr->m_left->m_data_type.m_type) {
+                    case TokenType::INT_TYPE:
+                        switch(expr->m_op.m_type) {
+                            case TokenType::EQUAL_EQUAL: emit_op(OpCode::EQUAL_INT, line); return;
+                            case TokenType::BANG_EQUAL: emit_op(OpCode::NOT_EQUAL_INT, line); return;
+                            case TokenType::LESS: emit_op(OpCode::LESS_INT, line); return;
+                            case TokenType::LESS_EQUAL: emit_op(OpCode::LESS_EQUAL_INT, line); return;
+                            case TokenType::GREATER: emit_op(OpCode::GREATER_INT, line); return;
+                            case TokenType::GREATER_EQUAL: emit_op(OpCode::GREATER_EQUAL_INT, line); return;
+                            default: break;
+                        }
+                        break;
+                    case TokenType::FLOAT_TYPE:
+                        switch(expr->m_op.m_type) {
+                            case TokenType::EQUAL_EQUAL: emit_op(OpCode::EQUAL_FLOAT, line); return;
+                            case TokenType::BANG_EQUAL: emit_op(OpCode::NOT_EQUAL_FLOAT, line); return;
+                            case TokenType::LESS: emit_op(OpCode::LESS_FLOAT, line); return;
+                            case TokenType::LESS_EQUAL: emit_op(OpCode::LESS_EQUAL_FLOAT, line); return;
+                            case TokenType::GREATER: emit_op(OpCode::GREATER_FLOAT, line); return;
+                            case TokenType::GREATER_EQUAL: emit_op(OpCode::GREATER_EQUAL_FLOAT, line); return;
+                            default: break;
+                        }
+                        break;
+                    case TokenType::BOOL_TYPE:
+                        switch(expr->m_op.m_type) {
+                            case TokenType::EQUAL_EQUAL: emit_op(OpCode::EQUAL_BOOL, line); return;
+                            case TokenType::BANG_EQUAL: emit_op(OpCode::NOT_EQUAL_BOOL, line); return;
+                            default: break;
+                        }
+                        break;
+                    case TokenType::STRING_TYPE:
+                        switch(expr->m_op.m_type) {
+                            case TokenType::EQUAL_EQUAL: emit_op(OpCode::EQUAL_STRING, line); return;
+                            case TokenType::BANG_EQUAL: emit_op(OpCode::NOT_EQUAL_STRING, line); return;
+                            default: break;
+                        }
+                        break;
+                    default:
+                        break;
+                }
+                add_error(expr->m_op, "Invalid logical operator.");
+            }
+
+            /*
+             * Variables and Functions
+             */
+            void visit(DeclVar* expr) {
+                if (expr->m_value) {
+                    compile(expr->m_value);
+                } else {
+                    emit_op(OpCode::NIL, expr->m_name.m_line);
+                }
+                emit_op(OpCode::DEFINE_VAR, expr->m_name.m_line);
+                emit_short(expr->m_slot, expr->m_name);
+            }
+
+            void visit(GetVar* expr) {
+                if (expr->m_env.m_type != TokenType::NIL) {
+                    emit_op(OpCode::GET_FIELD, expr->m_name.m_line);
+                    emit_short(expr->m_depth, expr->m_env);
+                    emit_short(expr->m_slot, expr->m_env);
+                    emit_name(expr->m_name);
+                    emit_short(m_chunk->add_cache(), expr->m_name);
+                    return;
+                }
+
+                emit_op(OpCode::GET_VAR, expr->m_name.m_line);
+                emit_short(expr->m_depth, expr->m_name);
+                emit_short(expr->m_slot, expr->m_name);
+            }
+
+            void visit(SetVar* expr) {
+                compile(expr->m_value);
+                if (expr->m_env.m_type != TokenType::NIL) {
+                    emit_op(OpCode::SET_FIELD, expr->m_name.m_line);
+                    emit_short(expr->m_depth, expr->m_env);
+                    emit_short(expr->m_slot, expr->m_env);
+                    emit_name(expr->m_name);
+                    emit_short(m_chunk->add_cache(), expr->m_name);
+                    return;
+                }
+
+                emit_op(OpCode::SET_VAR, expr->m_name.m_line);
+                emit_short(expr->m_depth, expr->m_name);
+                emit_short(expr->m_slot, expr->m_name);
+            }
+
+            void visit(DeclFun* expr) {
+                emit_constant(Value(compile_function(expr)), expr->m_name);
+                emit_op(OpCode::DEFINE_VAR, expr->m_name.m_line);
+                emit_short(expr->m_slot, expr->m_name);
+            }
+
+            void visit(CallFun* expr) {
+                for (Expr* e: expr->m_arguments) {
+                    compile(e);
+                }
+
+                if (expr->m_env.m_type != TokenType::NIL) {
+                    emit_op(OpCode::INVOKE, expr->m_name.m_line);
+                    emit_short(expr->m_depth, expr->m_env);
+                    emit_short(expr->m_slot, expr->m_env);
+                    emit_name(expr->m_name);
+                    emit_short(m_chunk->add_cache(), expr->m_name);
+                } else {
+                    emit_op(OpCode::CALL, expr->m_name.m_line);
+                    emit_short(expr->m_depth, expr->m_name);
+                    emit_short(expr->m_slot, expr->m_name);
+                }
+                emit_short(int(expr->m_arguments.size()), expr->m_name);
+            }
+
+            void visit(Return* expr) {
+                if (expr->m_value) {
+                    compile(expr->m_value);
+                } else {
+                    emit_op(OpCode::NIL, expr->m_name.m_line);
+                }
+                emit_op(OpCode::RETURN, expr->m_name.m_line);
+            }
+
+            /*
+             * Control Flow
+             */
+            //control flow only produces nil when used as a value
+            void visit(Block* expr) {
+                exec(expr);
+                emit_op(OpCode::NIL, expr->m_name.m_line);
+            }
+
+            void visit(If* expr) {
+                exec(expr);
+                emit_op(OpCode::NIL, expr->m_name.m_line);
+            }
+
+            void visit(For* expr) {
+                exec(expr);
+                emit_op(OpCode::NIL, expr->m_name.m_line);
+            }
+
+            void visit(While* expr) {
+                exec(expr);
+                emit_op(OpCode::NIL, expr->m_name.m_line);
+            }
+
+            /*
+             * Classes
+             */
+            void visit(DeclClass* expr) {
+                //field initializers are evaluated where the class is declared
+                for (Expr* field: expr->m_fields) {
+                    DeclVar* decl_var = expr_cast<DeclVar>(field);
+                    if (decl_var->m_value) {
+                        compile(decl_var->m_value);
+                    } else {
+                        emit_op(OpCode::NIL, decl_var->m_name.m_line);
+                    }
+                }
+
+                std::vector<int> method_constants;
+                for (Expr* method: expr->m_methods) {
+                    DeclFun* decl_fun = expr_cast<DeclFun>(method);
+                    method_constants.push_back(m_chunk->add_constant(Value(compile_function(decl_fun))));
+                }
+
+                emit_op(OpCode::CLASS, expr->m_name.m_line);
+                emit_short(expr->m_slot, expr->m_name);
+                if (expr->m_base.m_type != TokenType::NIL) {
+                    emit_short(expr->m_base_depth, expr->m_base);
+                    emit_short(expr->m_base_slot, expr->m_base);
+                } else {
+                    m_chunk->write_short(0, expr->m_name.m_line);
+                    m_chunk->write_short(Chunk::NO_OPERAND, expr->m_name.m_line);
+                }
+
+                emit_short(int(expr->m_fields.size()), expr->m_name);
+                for (Expr* field: expr->m_fields) {
+                    emit_name(expr_cast<DeclVar>(field)->m_name);
+                }
+
+                emit_short(int(expr->m_methods.size()), expr->m_name);
+                for (int i = 0; i < int(expr->m_methods.size()); i++) {
+                    emit_name(expr_cast<DeclFun>(expr->m_methods.at(i))->m_name);
+                    emit_short(method_constants.at(i), expr->m_name);
+                }
+            }
+
+            /*
+             * Statements
+             */
+
+            //expressions in statement position discard their value
+            Completion exec(Unary* expr) { compile(expr); emit_op(OpCode::POP, expr->m_op.m_line); return Completion::NORMAL; }
+            Completion exec(Binary* expr) { compile(expr); emit_op(OpCode::POP, expr->m_op.m_line); return Completion::NORMAL; }
+            Completion exec(Group* expr) { compile(expr); emit_op(OpCode::POP, expr->m_name.m_line); return Completion::NORMAL; }
+            Completion exec(Literal*) { return Completion::NORMAL; }
+            Completion exec(Logic* expr) { compile(expr); emit_op(OpCode::POP, expr->m_op.m_line); return Completion::NORMAL; }
+
+            Completion exec(DeclVar* expr) { compile(expr); emit_op(OpCode::POP, expr->m_name.m_line); return Completion::NORMAL; }
+            Completion exec(GetVar*) { return Completion::NORMAL; }
+            Completion exec(SetVar* expr) {
+                if (!compile_increment(expr)) {
+                    compile(expr);
+                    emit_op(OpCode::POP, expr->m_name.m_line);
+                }
+                return Completion::NORMAL;
+            }
+            Completion exec(DeclFun* expr) { compile(expr); emit_op(OpCode::POP, expr->m_name.m_line); return Completion::NORMAL; }
+            Completion exec(CallFun* expr) { compile(expr); emit_op(OpCode::POP, expr->m_name.m_line); return Completion::NORMAL; }
+            Completion exec(DeclClass* expr) { compile(expr); emit_op(OpCode::POP, expr->m_name.m_line); return Completion::NORMAL; }
+
+            Completion exec(Return* expr) {
+                compile(expr);
+                return Completion::RETURN;
+            }
+
+            Completion exec(Block* expr) {
+                emit_op(OpCode::PUSH_SCOPE, expr->m_name.m_line);
+                emit_short(expr->m_slot_count, expr->m_name);
+                compile_statements(expr->m_expressions);
+                emit_op(OpCode::POP_SCOPE, expr->m_name.m_line);
+                return Completion::NORMAL;
+            }
+
+            Completion exec(If* expr) {
+                compile(expr->m_condition);
+                int then_jump = emit_jump(OpCode::JUMP_IF_FALSE, expr->m_name);
+
+                compile_statement(expr->m_then_branch);
+
+                if (expr->m_else_branch) {
+                    int else_jump = emit_jump(OpCode::JUMP, expr->m_name);
+                    patch_jump(then_jump, expr->m_name);
+                    compile_statement(expr->m_else_branch);
+                    patch_jump(else_jump, expr->m_name);
+                } else {
+                    patch_jump(then_jump, expr->m_name);
+                }
+
+                return Completion::NORMAL;
+            }
+
+            Completion exec(For* expr) {
+                if (expr->m_initializer) {
+                    compile_statement(expr->m_initializer);
+                }
+
+                //same as tree-walker: a loop without a condition never runs its body
+                if (expr->m_condition) {
+                    int loop_start = int(m_chunk->m_code.size());
+                    compile(expr->m_condition);
+                    int exit_jump = emit_jump(OpCode::JUMP_IF_FALSE, expr->m_name);
+
+                    compile_statement(expr->m_body);
+                    if (expr->m_update) {
+                        compile_statement(expr->m_update);
+                    }
+                    emit_loop(loop_start, expr->m_name);
+
+                    patch_jump(exit_jump, expr->m_name);
+                }
+
+                return Completion::NORMAL;
+            }
+
+            Completion exec(While* expr) {
+                int loop_start = int(m_chunk->m_code.size());
+                compile(expr->m_condition);
+                int exit_jump = emit_jump(OpCode::JUMP_IF_FALSE, expr->m_name);
+
+                compile_statement(expr->m_body);
+                emit_loop(loop_start, expr->m_name);
+
+                patch_jump(exit_jump, expr->m_name);
+                return Completion::NORMAL;
+            }
+
+    };
+
+}
+
+
+#endif // ZEBRA_COMPILER_H
@@ -3,20 +3,23 @@
 
 #include <string>
 #include "TokenType.hpp"
+#include "Symbol.hpp"
 
 namespace zebra {
 
     class DataType {
         public:
             TokenType m_type;
-            std::string m_lexeme;
+            int m_symbol; //class name for instance types
         public:
-            DataType(TokenType type, const std::string& lexeme): m_type(type), m_lexeme(lexeme) {}
-            DataType(TokenType type): m_type(type), m_lexeme("") {}
-            DataType(): m_type(TokenType::NIL_TYPE), m_lexeme("") {}
-            ~DataType() {}
+            DataType(TokenType type, int symbol): m_type(type), m_symbol(symbol) {}
+            DataType(TokenType type): m_type(type), m_symbol(Symbols::NONE) {}
+            DataType(): m_type(TokenType::NIL_TYPE), m_symbol(Symbols::NONE) {}
             static bool equal(DataType d1, DataType d2) {
-                return d1.m_type == d2.m_type && d1.m_lexeme == d2.m_lexeme;
+                return d1.m_type == d2.m_type && d1.m_symbol == d2.m_symbol;
+            }
+            const std::string& name() const {
+                return Symbols::name(m_symbol);
             }
     };
 
@@ -3,52 +3,72 @@
 
 namespace zebra {
 
-    Environment::Environment(std::shared_ptr<Environment> closure, bool is_func): m_closure(closure), m_is_function(is_func) {}
+    Environment::Environment(std::shared_ptr<Environment> closure, bool is_func, int slot_count): 
+        m_slots(slot_count), m_closure(closure), m_is_function(is_func) {}
 
     Environment::Environment() {}
 
-    void Environment::define_global(Token name, std::shared_ptr<Object> value) {
-        if (m_closure) {
-            m_closure->define_global(name, value);
-            return;
+    void Environment::define(int slot, const Value& value) {
+        //the global frame grows as top-level declarations are executed
+        if (slot >= int(m_slots.size())) {
+            m_slots.resize(slot + 1);
         }
+        m_slots[slot] = value; 
+    }
 
-        m_values[name.m_lexeme] = value; 
+    void Environment::assign(int depth, int slot, const Value& value) {
+        ancestor(depth)->m_slots[slot] = value;
     }
 
-    void Environment::define(Token name, std::shared_ptr<Object> value) {
-        m_values[name.m_lexeme] = value; 
+    const Value& Environment::get(int depth, int slot) {
+        return ancestor(depth)->m_slots[slot];
     }
 
-    void Environment::assign(Token name, std::shared_ptr<Object> value) {
-        if(m_values.count(name.m_lexeme) == 0) {
-            m_closure->assign(name, value);
-        }
-        m_values[name.m_lexeme] = value->clone(); 
+    const Value& Environment::get(int slot) const {
+        return m_slots[slot];
     }
 
-    std::shared_ptr<Object> Environment::get(Token name) {
-        if(m_values.count(name.m_lexeme) == 0) {
-            return m_closure->get(name);
+    Environment* Environment::ancestor(int depth) {
+        Environment* env = this;
+        for (int i = 0; i < depth; i++) {
+            env = env->m_closure.get();
         }
+        return env;
+    }
 
-        return m_values[name.m_lexeme];
+    std::shared_ptr<Environment> Environment::get_closure() const {
+        return m_closure;
     }
 
-    void Environment::set_return(std::shared_ptr<Object> ret) {
-        if (!m_is_function) {
-            m_closure->set_return(ret); 
-        } else {
-            m_return = ret;
-        }
+    bool Environment::is_function() const {
+        return m_is_function;
+    }
+
+    //slot storage keeps its capacity, so reusing a frame of similar size does not allocate
+    void Environment::reset(std::shared_ptr<Environment> closure, bool is_func, int slot_count) {
+        m_slots.assign(slot_count, Value());
+        m_closure = std::move(closure);
+        m_is_function = is_func;
     }
 
-    std::shared_ptr<Object> Environment::get_return() {
-        if(m_closure && !m_return) {
-            return m_closure->get_return(); 
+
+    std::shared_ptr<Environment> EnvironmentPool::acquire(std::shared_ptr<Environment> closure, bool is_func, int slot_count) {
+        if (m_free.empty()) {
+            return std::make_shared<Environment>(std::move(closure), is_func, slot_count);
         }
 
-        return m_return;
+        std::shared_ptr<Environment> env = std::move(m_free.back());
+        m_free.pop_back();
+        env->reset(std::move(closure), is_func, slot_count);
+        return env;
+    }
+
+    void EnvironmentPool::release(std::shared_ptr<Environment> env) {
+        if (env.use_count() != 1) return;
+
+        //drop references held by the frame now rather than when it is next reused
+        env->reset(nullptr, false, 0);
+        m_free.push_back(std::move(env));
     }
 
 
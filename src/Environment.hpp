@@ -2,31 +2,49 @@
 #define ZEBRA_ENVIRONMENT_H
 
 #include <memory>
-#include <unordered_map>
+#include <vector>
 #include "RuntimeError.hpp"
 #include "Token.hpp"
+#include "Value.hpp"
 
 
 namespace zebra {
 
     class Object;
 
+    /*
+     * Fixed-size frame of variable slots.  Slots and scope depths are assigned by the Resolver.
+     */
     class Environment {
         private:
-            std::unordered_map<std::string, std::shared_ptr<Object>> m_values;
+            std::vector<Value> m_slots;
             std::shared_ptr<Environment> m_closure {nullptr};
-            std::shared_ptr<Environment> m_global {nullptr};
-            std::shared_ptr<Object> m_return {nullptr};
             bool m_is_function {false};
         public:
-            Environment(std::shared_ptr<Environment> closure, bool is_func);
+            Environment(std::shared_ptr<Environment> closure, bool is_func, int slot_count);
             Environment();
-            void define_global(Token name, std::shared_ptr<Object> value);
-            void define(Token name, std::shared_ptr<Object> value);
-            void assign(Token name, std::shared_ptr<Object> value);
-            std::shared_ptr<Object> get(Token name);
-            void set_return(std::shared_ptr<Object> ret);
-            std::shared_ptr<Object> get_return();
+            void define(int slot, const Value& value);
+            void assign(int depth, int slot, const Value& value);
+            const Value& get(int depth, int slot);
+            const Value& get(int slot) const;
+            Environment* ancestor(int depth);
+            bool is_function() const;
+            std::shared_ptr<Environment> get_closure() const;
+        private:
+            friend class EnvironmentPool;
+            void reset(std::shared_ptr<Environment> closure, bool is_func, int slot_count);
+    };
+
+    /*
+     * Recycles block and call frames so entering a scope does not allocate once the pool is warm.
+     * A frame still referenced elsewhere when released (e.g. by a class instance) is left alone.
+     */
+    class EnvironmentPool {
+        private:
+            std::vector<std::shared_ptr<Environment>> m_free;
+        public:
+            std::shared_ptr<Environment> acquire(std::shared_ptr<Environment> closure, bool is_func, int slot_count);
+            void release(std::shared_ptr<Environment> env);
     };
 
 
@@ -37,4 +55,3 @@ namespace zebra {
 
 
 #endif // ZEBRA_ENVIRONMENT_H
-
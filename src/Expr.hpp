@@ -2,10 +2,18 @@
 #define ZEBRA_EXPR_H
 
 #include <string>
+#include <vector>
 #include <memory>
-#include <unordered_map>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <iterator>
 #include "Token.hpp"
 #include "DataType.hpp"
+#include "Value.hpp"
+#include "InlineCache.hpp"
 
 namespace zebra {
 
@@ -13,7 +21,7 @@ namespace zebra {
 
 
     /*
-     * Forward declare expressions for interfaces
+     * Forward declare expressions for ExprDispatch
      * This is also a summary of the order
      */
 
@@ -37,70 +45,35 @@ namespace zebra {
 
     struct DeclClass;
 
-    struct ExprStringVisitor {
-        virtual std::string visit(Unary* expr) = 0;
-        virtual std::string visit(Binary* expr) = 0;
-        virtual std::string visit(Group* expr) = 0;
-        virtual std::string visit(Literal* expr) = 0;
-        virtual std::string visit(Logic* expr) = 0;
-
-        virtual std::string visit(DeclVar* expr) = 0;
-        virtual std::string visit(GetVar* expr) = 0;
-        virtual std::string visit(SetVar* expr) = 0;
-        virtual std::string visit(DeclFun* expr) = 0;
-        virtual std::string visit(CallFun* expr) = 0;
-        virtual std::string visit(Return* expr) = 0;
-
-        virtual std::string visit(Block* expr) = 0;
-        virtual std::string visit(If* expr) = 0;
-        virtual std::string visit(For* expr) = 0;
-        virtual std::string visit(While* expr) = 0;
-
-        virtual std::string visit(DeclClass* expr) = 0;
+    enum class ExprKind: uint8_t {
+        UNARY,
+        BINARY,
+        GROUP,
+        LITERAL,
+        LOGIC,
+
+        DECL_VAR,
+        GET_VAR,
+        SET_VAR,
+        DECL_FUN,
+        CALL_FUN,
+        RETURN,
+
+        BLOCK,
+        IF,
+        FOR,
+        WHILE,
+
+        DECL_CLASS
     };
 
-    struct ExprObjectVisitor {
-        virtual std::shared_ptr<Object> visit(Unary* expr) = 0;
-        virtual std::shared_ptr<Object> visit(Binary* expr) = 0;
-        virtual std::shared_ptr<Object> visit(Group* expr) = 0;
-        virtual std::shared_ptr<Object> visit(Literal* expr) = 0;
-        virtual std::shared_ptr<Object> visit(Logic* expr) = 0;
-
-        virtual std::shared_ptr<Object> visit(DeclVar* expr) = 0;
-        virtual std::shared_ptr<Object> visit(GetVar* expr) = 0;
-        virtual std::shared_ptr<Object> visit(SetVar* expr) = 0;
-        virtual std::shared_ptr<Object> visit(DeclFun* expr) = 0;
-        virtual std::shared_ptr<Object> visit(CallFun* expr) = 0;
-        virtual std::shared_ptr<Object> visit(Return* expr) = 0;
-
-        virtual std::shared_ptr<Object> visit(Block* expr) = 0;
-        virtual std::shared_ptr<Object> visit(If* expr) = 0;
-        virtual std::shared_ptr<Object> visit(For* expr) = 0;
-        virtual std::shared_ptr<Object> visit(While* expr) = 0;
-
-        virtual std::shared_ptr<Object> visit(DeclClass* expr) = 0;
-    };
-
-    struct DataTypeVisitor {
-        virtual DataType visit(Unary* expr) = 0;
-        virtual DataType visit(Binary* expr) = 0;
-        virtual DataType visit(Group* expr) = 0;
-        virtual DataType visit(Literal* expr) = 0;
-        virtual DataType visit(Logic* expr) = 0;
-
-        virtual DataType visit(DeclVar* expr) = 0;
-        virtual DataType visit(GetVar* expr) = 0;
-        virtual DataType visit(SetVar* expr) = 0;
-        virtual DataType visit(DeclFun* expr) = 0;
-        virtual DataType visit(CallFun* expr) = 0;
-        virtual DataType visit(Return* expr) = 0;
-
-        virtual DataType visit(Block* expr) = 0;
-        virtual DataType visit(If* expr) = 0;
-        virtual DataType visit(For* expr) = 0;
-        virtual DataType visit(While* expr) = 0;
-
-        virtual DataType visit(DeclClass* expr) = 0;
+    /*
+     * Runs an expression in statement position, where its value is never read.
+     * The completion tells the enclosing statements whether to keep going.
+     */
+    enum class Completion {
+        NORMAL,
+        RETURN
     };
 
     /*
@@ -108,10 +81,26 @@ namespace zebra {
      */
     struct Expr {
         public:
-            virtual ~Expr() {}
-            virtual std::string accept(ExprStringVisitor& visitor) = 0;
-            virtual std::shared_ptr<Object> accept(ExprObjectVisitor& visitor) = 0;
-            virtual DataType accept(DataTypeVisitor& visitor) = 0;
+            Expr(ExprKind kind): m_kind(kind) {}
+        public:
+            ExprKind m_kind;
+            DataType m_data_type; //set by Typer
+    };
+
+    /*
+     * Child expressions of a node, stored as an array in the AstArena
+     */
+    class ExprList {
+        private:
+            Expr** m_items;
+            uint32_t m_count;
+        public:
+            ExprList(): m_items(nullptr), m_count(0) {}
+            ExprList(Expr** items, uint32_t count): m_items(items), m_count(count) {}
+            Expr** begin() const { return m_items; }
+            Expr** end() const { return m_items + m_count; }
+            int size() const { return int(m_count); }
+            Expr* at(int i) const { return m_items[i]; }
     };
 
 
@@ -120,65 +109,51 @@ namespace zebra {
      */
     struct Unary: public Expr {
         public:
-            Unary(Token op, std::shared_ptr<Expr> right): m_op(op), m_right(right) {}
-            ~Unary() {}
-            std::string accept(ExprStringVisitor& visitor) { return visitor.visit(this); }
-            std::shared_ptr<Object> accept(ExprObjectVisitor& visitor) { return visitor.visit(this); }
-            DataType accept(DataTypeVisitor& visitor) { return visitor.visit(this); }
+            static const ExprKind KIND = ExprKind::UNARY;
+            Unary(Token op, Expr* right): Expr(KIND), m_op(op), m_right(right) {}
         public:
             Token m_op;
-            std::shared_ptr<Expr> m_right;
+            Expr* m_right;
     };
 
     struct Binary: public Expr {
         public:
-            Binary(Token op, std::shared_ptr<Expr> left, std::shared_ptr<Expr> right): m_op(op), m_left(left), m_right(right) {}
-            ~Binary() {}
-            std::string accept(ExprStringVisitor& visitor) { return visitor.visit(this); }
-            std::shared_ptr<Object> accept(ExprObjectVisitor& visitor) { return visitor.visit(this); }
-            DataType accept(DataTypeVisitor& visitor) { return visitor.visit(this); }
+            static const ExprKind KIND = ExprKind::BINARY;
+            Binary(Token op, Expr* left, Expr* right): Expr(KIND), m_op(op), m_left(left), m_right(right) {}
         public:
             Token m_op;
-            std::shared_ptr<Expr> m_left;
-            std::shared_ptr<Expr> m_right;
+            Expr* m_left;
+            Expr* m_right;
     };
 
 
     struct Group: public Expr {
         public:
-            Group(Token name, std::shared_ptr<Expr> expr): m_name(name), m_expr(expr) {}
-            ~Group() {}
-            std::string accept(ExprStringVisitor& visitor) { return visitor.visit(this); }
-            std::shared_ptr<Object> accept(ExprObjectVisitor& visitor) { return visitor.visit(this); }
-            DataType accept(DataTypeVisitor& visitor) { return visitor.visit(this); }
+            static const ExprKind KIND = ExprKind::GROUP;
+            Group(Token name, Expr* expr): Expr(KIND), m_name(name), m_expr(expr) {}
         public:
             Token m_name;
-            std::shared_ptr<Expr> m_expr;
+            Expr* m_expr;
     };
 
     struct Literal: public Expr {
         public:
-            Literal(Token token): m_token(token) {}
-            ~Literal() {}
-            std::string accept(ExprStringVisitor& visitor) { return visitor.visit(this); }
-            std::shared_ptr<Object> accept(ExprObjectVisitor& visitor) { return visitor.visit(this); }
-            DataType accept(DataTypeVisitor& visitor) { return visitor.visit(this); }
+            static const ExprKind KIND = ExprKind::LITERAL;
+            Literal(Token token): Expr(KIND), m_token(token) {}
         public:
             Token m_token;
+            Value m_value; //set by Resolver
     };
 
 
     struct Logic: public Expr {
         public:
-            Logic(Token op, std::shared_ptr<Expr> left, std::shared_ptr<Expr> right): m_op(op), m_left(left), m_right(right) {}
-            ~Logic() {}
-            std::string accept(ExprStringVisitor& visitor) { return visitor.visit(this); }
-            std::shared_ptr<Object> accept(ExprObjectVisitor& visitor) { return visitor.visit(this); }
-            DataType accept(DataTypeVisitor& visitor) { return visitor.visit(this); }
+            static const ExprKind KIND = ExprKind::LOGIC;
+            Logic(Token op, Expr* left, Expr* right): Expr(KIND), m_op(op), m_left(left), m_right(right) {}
         public:
             Token m_op;
-            std::shared_ptr<Expr> m_left;
-            std::shared_ptr<Expr> m_right;
+            Expr* m_left;
+            Expr* m_right;
     };
 
     /*
@@ -186,84 +161,79 @@ namespace zebra {
      */
     struct DeclVar: public Expr {
         public:
-            DeclVar(Token name, Token type, std::shared_ptr<Expr> value): 
-                m_name(name), m_type(type), m_value(value) {}
-            ~DeclVar() {}
-            std::string accept(ExprStringVisitor& visitor) { return visitor.visit(this); }
-            std::shared_ptr<Object> accept(ExprObjectVisitor& visitor) { return visitor.visit(this); }
-            DataType accept(DataTypeVisitor& visitor) { return visitor.visit(this); }
+            static const ExprKind KIND = ExprKind::DECL_VAR;
+            DeclVar(Token name, Token type, Expr* value): 
+                Expr(KIND), m_name(name), m_type(type), m_value(value) {}
         public:
             Token m_name;
             Token m_type;
-            std::shared_ptr<Expr> m_value;
+            Expr* m_value;
+            int m_slot {-1}; //set by Resolver
     };
 
     struct GetVar: public Expr {
         public:
-            GetVar(Token name, Token env): m_name(name), m_env(env) {}
-            ~GetVar() {}
-            std::string accept(ExprStringVisitor& visitor) { return visitor.visit(this); }
-            std::shared_ptr<Object> accept(ExprObjectVisitor& visitor) { return visitor.visit(this); }
-            DataType accept(DataTypeVisitor& visitor) { return visitor.visit(this); }
+            static const ExprKind KIND = ExprKind::GET_VAR;
+            GetVar(Token name, Token env): Expr(KIND), m_name(name), m_env(env) {}
         public:
             Token m_name;
             Token m_env;
+            int m_depth {-1}; //set by Resolver - refers to instance if m_env is set
+            int m_slot {-1};
+            InlineCache m_cache; //member slot by receiver class, filled in by the Interpreter
     };
 
     struct SetVar: public Expr {
         public:
-            SetVar(Token name, Token env, std::shared_ptr<Expr> value): 
-                m_name(name), m_env(env), m_value(value) {}
-            ~SetVar() {}
-            std::string accept(ExprStringVisitor& visitor) { return visitor.visit(this); }
-            std::shared_ptr<Object> accept(ExprObjectVisitor& visitor) { return visitor.visit(this); }
-            DataType accept(DataTypeVisitor& visitor) { return visitor.visit(this); }
+            static const ExprKind KIND = ExprKind::SET_VAR;
+            SetVar(Token name, Token env, Expr* value): 
+                Expr(KIND), m_name(name), m_env(env), m_value(value) {}
         public:
             Token m_name;
             Token m_env;
-            std::shared_ptr<Expr> m_value;
+            Expr* m_value;
+            int m_depth {-1}; //set by Resolver - refers to instance if m_env is set
+            int m_slot {-1};
+            InlineCache m_cache; //member slot by receiver class, filled in by the Interpreter
     };
 
     struct DeclFun: public Expr {
         public:
-            DeclFun(Token name, std::vector<std::shared_ptr<Expr>> parameters, TokenType type, std::shared_ptr<Expr> body): 
-                m_name(name), m_parameters(parameters), m_return_type(type), m_body(body) {}
-            ~DeclFun() {}
-            std::string accept(ExprStringVisitor& visitor) { return visitor.visit(this); }
-            std::shared_ptr<Object> accept(ExprObjectVisitor& visitor) { return visitor.visit(this); }
-            DataType accept(DataTypeVisitor& visitor) { return visitor.visit(this); }
+            static const ExprKind KIND = ExprKind::DECL_FUN;
+            DeclFun(Token name, ExprList parameters, Token type, Expr* body): 
+                Expr(KIND), m_name(name), m_parameters(parameters), m_return_type(type), m_body(body) {}
         public:
             Token m_name;
-            std::vector<std::shared_ptr<Expr>> m_parameters;
-            TokenType m_return_type;
-            std::shared_ptr<Expr> m_body;
+            ExprList m_parameters;
+            Token m_return_type; //class return types carry the class name, like DeclVar::m_type
+            Expr* m_body; //null while the Parser has skipped it, until BodyLoader parses it
+            Token m_body_start; //'{' of a skipped body, whose position is where scanning resumes
+            int m_slot {-1}; //set by Resolver
+            int m_slot_count {0}; //parameters and locals in body
     };
 
     struct CallFun: public Expr {
         public:
-            CallFun(Token name, Token env, std::vector<std::shared_ptr<Expr>> arguments): 
-                m_name(name), m_env(env), m_arguments(arguments) {}
-            ~CallFun() {}
-            std::string accept(ExprStringVisitor& visitor) { return visitor.visit(this); }
-            std::shared_ptr<Object> accept(ExprObjectVisitor& visitor) { return visitor.visit(this); }
-            DataType accept(DataTypeVisitor& visitor) { return visitor.visit(this); }
+            static const ExprKind KIND = ExprKind::CALL_FUN;
+            CallFun(Token name, Token env, ExprList arguments): 
+                Expr(KIND), m_name(name), m_env(env), m_arguments(arguments) {}
         public:
             Token m_name;
             Token m_env;
-            std::vector<std::shared_ptr<Expr>> m_arguments;
+            ExprList m_arguments;
+            int m_depth {-1}; //set by Resolver - refers to instance if m_env is set
+            int m_slot {-1};
+            InlineCache m_cache; //member slot by receiver class, filled in by the Interpreter
     };
 
     struct Return: public Expr {
         public:
-            Return(Token name, std::shared_ptr<Expr> value): 
-                m_name(name), m_value(value) {}
-            ~Return() {}
-            std::string accept(ExprStringVisitor& visitor) { return visitor.visit(this); }
-            std::shared_ptr<Object> accept(ExprObjectVisitor& visitor) { return visitor.visit(this); }
-            DataType accept(DataTypeVisitor& visitor) { return visitor.visit(this); }
+            static const ExprKind KIND = ExprKind::RETURN;
+            Return(Token name, Expr* value): 
+                Expr(KIND), m_name(name), m_value(value) {}
         public:
             Token m_name;
-            std::shared_ptr<Expr> m_value;
+            Expr* m_value;
     };
 
 
@@ -272,60 +242,49 @@ namespace zebra {
      */
     struct Block: public Expr {
         public:
-            Block(Token name, std::vector<std::shared_ptr<Expr>> expressions): m_name(name), m_expressions(expressions) {}
-            ~Block() {}
-            std::string accept(ExprStringVisitor& visitor) { return visitor.visit(this); }
-            std::shared_ptr<Object> accept(ExprObjectVisitor& visitor) { return visitor.visit(this); }
-            DataType accept(DataTypeVisitor& visitor) { return visitor.visit(this); }
+            static const ExprKind KIND = ExprKind::BLOCK;
+            Block(Token name, ExprList expressions): Expr(KIND), m_name(name), m_expressions(expressions) {}
         public:
             Token m_name;
-            std::vector<std::shared_ptr<Expr>> m_expressions;
+            ExprList m_expressions;
+            int m_slot_count {0}; //set by Resolver
     };
 
     struct If: public Expr {
         public:
-            If(Token name, std::shared_ptr<Expr> condition, std::shared_ptr<Expr> then_branch, std::shared_ptr<Expr> else_branch): 
-                m_name(name), m_condition(condition), m_then_branch(then_branch), m_else_branch(else_branch) {}
-            ~If() {}
-            std::string accept(ExprStringVisitor& visitor) { return visitor.visit(this); }
-            std::shared_ptr<Object> accept(ExprObjectVisitor& visitor) { return visitor.visit(this); }
-            DataType accept(DataTypeVisitor& visitor) { return visitor.visit(this); }
+            static const ExprKind KIND = ExprKind::IF;
+            If(Token name, Expr* condition, Expr* then_branch, Expr* else_branch): 
+                Expr(KIND), m_name(name), m_condition(condition), m_then_branch(then_branch), m_else_branch(else_branch) {}
         public:
             Token m_name;
-            std::shared_ptr<Expr> m_condition;
-            std::shared_ptr<Expr> m_then_branch;
-            std::shared_ptr<Expr> m_else_branch;
+            Expr* m_condition;
+            Expr* m_then_branch;
+            Expr* m_else_branch;
     };
 
     struct For: public Expr {
         public:
-            For(Token name, std::shared_ptr<Expr> initializer, std::shared_ptr<Expr> condition, std::shared_ptr<Expr> update, std::shared_ptr<Expr> body): 
-                m_name(name), m_initializer(initializer), m_condition(condition), m_update(update), m_body(body) {}
-            ~For() {}
-            std::string accept(ExprStringVisitor& visitor) { return visitor.visit(this); }
-            std::shared_ptr<Object> accept(ExprObjectVisitor& visitor) { return visitor.visit(this); }
-            DataType accept(DataTypeVisitor& visitor) { return visitor.visit(this); }
+            static const ExprKind KIND = ExprKind::FOR;
+            For(Token name, Expr* initializer, Expr* condition, Expr* update, Expr* body): 
+                Expr(KIND), m_name(name), m_initializer(initializer), m_condition(condition), m_update(update), m_body(body) {}
         public:
             Token m_name;
-            std::shared_ptr<Expr> m_initializer;
-            std::shared_ptr<Expr> m_condition;
-            std::shared_ptr<Expr> m_update;
-            std::shared_ptr<Expr> m_body;
+            Expr* m_initializer;
+            Expr* m_condition;
+            Expr* m_update;
+            Expr* m_body;
     };
 
 
     struct While: public Expr {
         public:
-            While(Token name, std::shared_ptr<Expr> condition, std::shared_ptr<Expr> body): 
-                m_name(name), m_condition(condition), m_body(body) {}
-            ~While() {}
-            std::string accept(ExprStringVisitor& visitor) { return visitor.visit(this); }
-            std::shared_ptr<Object> accept(ExprObjectVisitor& visitor) { return visitor.visit(this); }
-            DataType accept(DataTypeVisitor& visitor) { return visitor.visit(this); }
+            static const ExprKind KIND = ExprKind::WHILE;
+            While(Token name, Expr* condition, Expr* body): 
+                Expr(KIND), m_name(name), m_condition(condition), m_body(body) {}
         public:
             Token m_name;
-            std::shared_ptr<Expr> m_condition;
-            std::shared_ptr<Expr> m_body;
+            Expr* m_condition;
+            Expr* m_body;
     };
 
     /*
@@ -333,17 +292,145 @@ namespace zebra {
      */
     struct DeclClass: public Expr {
         public:
-            DeclClass(Token name, Token base, std::vector<std::shared_ptr<Expr>> fields, std::vector<std::shared_ptr<Expr>> methods):
-                m_name(name), m_base(base), m_fields(fields), m_methods(methods) {}
-            ~DeclClass() {}
-            std::string accept(ExprStringVisitor& visitor) { return visitor.visit(this); }
-            std::shared_ptr<Object> accept(ExprObjectVisitor& visitor) { return visitor.visit(this); }
-            DataType accept(DataTypeVisitor& visitor) { return visitor.visit(this); }
+            static const ExprKind KIND = ExprKind::DECL_CLASS;
+            DeclClass(Token name, Token base, ExprList fields, ExprList methods):
+                Expr(KIND), m_name(name), m_base(base), m_fields(fields), m_methods(methods) {}
         public:
             Token m_name;
             Token m_base;
-            std::vector<std::shared_ptr<Expr>> m_fields;
-            std::vector<std::shared_ptr<Expr>> m_methods;
+            ExprList m_fields;
+            ExprList m_methods;
+            int m_slot {-1}; //set by Resolver
+            int m_base_depth {-1};
+            int m_base_slot {-1};
+    };
+
+    //nullptr unless expr is a T
+    template <typename T>
+    T* expr_cast(Expr* expr) {
+        return expr && expr->m_kind == T::KIND ? static_cast<T*>(expr) : nullptr;
+    }
+
+    /*
+     * Passes switch on the node kind instead of going through virtual accept() calls.  The pass
+     * type is known statically, so each case calls its visit() or exec() overload directly.
+     * Passes with private handlers declare ExprDispatch a friend.
+     */
+    struct ExprDispatch {
+        template <typename V>
+        static auto visit(V& visitor, Expr* expr) {
+            switch(expr->m_kind) {
+                case ExprKind::UNARY: return visitor.visit(static_cast<Unary*>(expr));
+                case ExprKind::BINARY: return visitor.visit(static_cast<Binary*>(expr));
+                case ExprKind::GROUP: return visitor.visit(static_cast<Group*>(expr));
+                case ExprKind::LITERAL: return visitor.visit(static_cast<Literal*>(expr));
+                case ExprKind::LOGIC: return visitor.visit(static_cast<Logic*>(expr));
+                case ExprKind::DECL_VAR: return visitor.visit(static_cast<DeclVar*>(expr));
+                case ExprKind::GET_VAR: return visitor.visit(static_cast<GetVar*>(expr));
+                case ExprKind::SET_VAR: return visitor.visit(static_cast<SetVar*>(expr));
+                case ExprKind::DECL_FUN: return visitor.visit(static_cast<DeclFun*>(expr));
+                case ExprKind::CALL_FUN: return visitor.visit(static_cast<CallFun*>(expr));
+                case ExprKind::RETURN: return visitor.visit(static_cast<Return*>(expr));
+                case ExprKind::BLOCK: return visitor.visit(static_cast<Block*>(expr));
+                case ExprKind::IF: return visitor.visit(static_cast<If*>(expr));
+                case ExprKind::FOR: return visitor.visit(static_cast<For*>(expr));
+                case ExprKind::WHILE: return visitor.visit(static_cast<While*>(expr));
+                case ExprKind::DECL_CLASS: break;
+            }
+            return visitor.visit(static_cast<DeclClass*>(expr));
+        }
+
+        template <typename V>
+        static Completion exec(V& visitor, Expr* expr) {
+            switch(expr->m_kind) {
+                case ExprKind::UNARY: return visitor.exec(static_cast<Unary*>(expr));
+                case ExprKind::BINARY: return visitor.exec(static_cast<Binary*>(expr));
+                case ExprKind::GROUP: return visitor.exec(static_cast<Group*>(expr));
+                case ExprKind::LITERAL: return visitor.exec(static_cast<Literal*>(expr));
+                case ExprKind::LOGIC: return visitor.exec(static_cast<Logic*>(expr));
+                case ExprKind::DECL_VAR: return visitor.exec(static_cast<DeclVar*>(expr));
+                case ExprKind::GET_VAR: return visitor.exec(static_cast<GetVar*>(expr));
+                case ExprKind::SET_VAR: return visitor.exec(static_cast<SetVar*>(expr));
+                case ExprKind::DECL_FUN: return visitor.exec(static_cast<DeclFun*>(expr));
+                case ExprKind::CALL_FUN: return visitor.exec(static_cast<CallFun*>(expr));
+                case ExprKind::RETURN: return visitor.exec(static_cast<Return*>(expr));
+                case ExprKind::BLOCK: return visitor.exec(static_cast<Block*>(expr));
+                case ExprKind::IF: return visitor.exec(static_cast<If*>(expr));
+                case ExprKind::FOR: return visitor.exec(static_cast<For*>(expr));
+                case ExprKind::WHILE: return visitor.exec(static_cast<While*>(expr));
+                case ExprKind::DECL_CLASS: break;
+            }
+            return visitor.exec(static_cast<DeclClass*>(expr));
+        }
+    };
+
+    /*
+     * Owns every node of a script's AST.  Nodes and child lists are bump allocated out of large
+     * blocks, so the tree sits in a few contiguous buffers that are released together when the
+     * arena goes away.  Literals are the only nodes holding a boxed Value, so only they are
+     * destroyed one by one.
+     */
+    class AstArena {
+        private:
+            static const size_t BLOCK_SIZE = 64 * 1024;
+            std::vector<std::unique_ptr<char[]>> m_blocks;
+            size_t m_used {BLOCK_SIZE};
+            std::vector<Literal*> m_literals;
+        public:
+            AstArena() {}
+            AstArena(const AstArena&) = delete;
+            AstArena& operator=(const AstArena&) = delete;
+            ~AstArena() {
+                for (Literal* literal: m_literals) {
+                    literal->~Literal();
+                }
+            }
+
+            template <typename T, typename... Args>
+            T* make(Args&&... args) {
+                static_assert(std::is_trivially_destructible<T>::value || std::is_same<T, Literal>::value,
+                              "AST nodes are freed without running their destructors");
+                T* node = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+                if constexpr (std::is_same<T, Literal>::value) {
+                    m_literals.push_back(node);
+                }
+                return node;
+            }
+
+            //takes over the nodes of another arena, which then live as long as this one
+            void absorb(AstArena& other) {
+                //kept in front so the last block is still the one being filled
+                m_blocks.insert(m_blocks.begin(), std::make_move_iterator(other.m_blocks.begin()),
+                                std::make_move_iterator(other.m_blocks.end()));
+                m_literals.insert(m_literals.end(), other.m_literals.begin(), other.m_literals.end());
+                other.m_blocks.clear();
+                other.m_literals.clear();
+                other.m_used = BLOCK_SIZE;
+            }
+
+            ExprList list(const std::vector<Expr*>& items) {
+                if (items.empty()) return ExprList();
+                Expr** data = static_cast<Expr**>(allocate(items.size() * sizeof(Expr*), alignof(Expr*)));
+                std::memcpy(data, items.data(), items.size() * sizeof(Expr*));
+                return ExprList(data, uint32_t(items.size()));
+            }
+
+        private:
+            void* allocate(size_t size, size_t align) {
+                //oversized lists get a block of their own, leaving the last block open for bumping
+                if (size > BLOCK_SIZE) {
+                    m_blocks.emplace(m_blocks.begin(), new char[size]);
+                    return m_blocks.front().get();
+                }
+
+                size_t offset = (m_used + align - 1) & ~(align - 1);
+                if (offset + size > BLOCK_SIZE) {
+                    m_blocks.emplace_back(new char[BLOCK_SIZE]);
+                    offset = 0;
+                }
+                m_used = offset + size;
+                return m_blocks.back().get() + offset;
+            }
     };
 
 }
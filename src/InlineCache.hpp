@@ -0,0 +1,38 @@
+#ifndef ZEBRA_INLINE_CACHE_H
+#define ZEBRA_INLINE_CACHE_H
+
+namespace zebra {
+
+    /*
+     * Member slots resolved at a single field access or method call site, keyed on the id of
+     * the receiver's class.  Most sites only ever see one class, so the first entry is checked
+     * first.  Once all entries are taken, further classes fall back to the lookup by name.
+     */
+    class InlineCache {
+        public:
+            static const int SIZE = 4;
+        private:
+            int m_class_ids[SIZE];
+            int m_slots[SIZE];
+            int m_count {0};
+        public:
+            //returns -1 on a miss
+            int lookup(int class_id) const {
+                for (int i = 0; i < m_count; i++) {
+                    if (m_class_ids[i] == class_id) return m_slots[i];
+                }
+                return -1;
+            }
+
+            void insert(int class_id, int slot) {
+                if (m_count == SIZE) return;
+                m_class_ids[m_count] = class_id;
+                m_slots[m_count] = slot;
+                m_count++;
+            }
+    };
+
+}
+
+
+#endif // ZEBRA_INLINE_CACHE_H
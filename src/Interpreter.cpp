@@ -1,3 +1,5 @@
+#include <cmath>
+#include <climits>
 #include "Interpreter.hpp"
 #include "Object.hpp"
 #include "Library.hpp"
@@ -5,24 +7,23 @@
 namespace zebra {
 
     Interpreter::Interpreter() {
+        //natives take the first slots of the global frame, in the order the Resolver declares them
         m_global = std::make_shared<Environment>();
-        m_environment = std::make_shared<Environment>(m_global, false);
-
-        std::shared_ptr<Object> print = std::make_shared<Print>();
-        std::shared_ptr<Object> input = std::make_shared<Input>();
-        std::shared_ptr<Object> clock_fun = std::make_shared<Clock>();
-
-        m_environment->define_global(Token(TokenType::FUN_TYPE, "print"), print);    
-        m_environment->define_global(Token(TokenType::FUN_TYPE, "input"), input);    
-        m_environment->define_global(Token(TokenType::FUN_TYPE, "clock"), clock_fun);    
+        m_environment = m_global;
 
+        std::vector<std::pair<std::string, std::shared_ptr<Callable>>> natives = native_functions();
+        for (int i = 0; i < int(natives.size()); i++) {
+            m_global->define(i, Value(natives.at(i).second));
+        }
     }
 
     Interpreter::~Interpreter() {}
 
-    ResultCode Interpreter::run(const std::vector<std::shared_ptr<Expr>> expressions) {
-        for(std::shared_ptr<Expr> expr: expressions) {
-            evaluate(expr.get());
+    ResultCode Interpreter::run(const std::vector<Expr*>& expressions) {
+        for(Expr* expr: expressions) {
+            if (execute(expr) == Completion::RETURN) {
+                break;
+            }
         }
 
         if(!m_error_flag) {
@@ -38,219 +39,231 @@ namespace zebra {
 
     void Interpreter::add_error(Token token, const std::string& message) {
         m_errors.emplace_back(token, message);
+        m_error_flag = true;
     }
 
-    std::shared_ptr<Object> Interpreter::evaluate(Expr* expr) {
-        return expr->accept(*this);
+    Value Interpreter::evaluate(Expr* expr) {
+        return ExprDispatch::visit(*this, expr);
+    }
+
+    //after a runtime error nothing else runs, and every enclosing statement unwinds as if returning
+    Completion Interpreter::execute(Expr* expr) {
+        if (m_error_flag) return Completion::RETURN;
+        Completion completion = ExprDispatch::exec(*this, expr);
+        return m_error_flag ? Completion::RETURN : completion;
     }
 
     /*
      * Basic
      */
 
-    std::shared_ptr<Object> Interpreter::visit(Unary* expr) {
-        std::shared_ptr<Object> right = expr->m_right->accept(*this);
+    //operand types come from the Typer, so each operator goes straight to its typed path
+    Value Interpreter::visit(Unary* expr) {
+        Value right = evaluate(expr->m_right);
 
-        if(expr->m_op.m_type == TokenType::MINUS) {
-            if (dynamic_cast<Float*>(right.get())) {
-                return std::make_shared<Float>(-dynamic_cast<Float*>(right.get())->m_value);
-            }else if (dynamic_cast<Int*>(right.get())) {
-                return std::make_shared<Int>(-dynamic_cast<Int*>(right.get())->m_value);
-            }
-        }else if(expr->m_op.m_type == TokenType::BANG) {
-            return std::make_shared<Bool>(!dynamic_cast<Bool*>(right.get())->m_value);
+        switch(expr->m_data_type.m_type) {
+            case TokenType::INT_TYPE: return Value(int(0u - unsigned(right.m_int)));
+            case TokenType::FLOAT_TYPE: return Value(-right.m_float);
+            case TokenType::BOOL_TYPE: return Value(!right.m_bool);
+            default: return Value();
         }
-
     }
 
-    std::shared_ptr<Object> Interpreter::visit(Binary* expr) {
-        std::shared_ptr<Object> left = expr->m_left->accept(*this);
-        std::shared_ptr<Object> right = expr->m_right->accept(*this);
-
-        if(dynamic_cast<Int*>(left.get())) {
-            int a = dynamic_cast<Int*>(left.get())->m_value;
-            int b = dynamic_cast<Int*>(right.get())->m_value;
-            switch(expr->m_op.m_type) {
-                case TokenType::PLUS: return std::make_shared<Int>(a + b);
-                case TokenType::MINUS: return std::make_shared<Int>(a - b);
-                case TokenType::STAR: return std::make_shared<Int>(a * b);
-                case TokenType::SLASH: return std::make_shared<Int>(a / b);
-                case TokenType::MOD: return std::make_shared<Int>(a % b);
-            }
-        }
-        if(dynamic_cast<Float*>(left.get())) {
-            float a = dynamic_cast<Float*>(left.get())->m_value;
-            float b = dynamic_cast<Float*>(right.get())->m_value;
-            switch(expr->m_op.m_type) {
-                case TokenType::PLUS: return std::make_shared<Float>(a + b);
-                case TokenType::MINUS: return std::make_shared<Float>(a - b);
-                case TokenType::STAR: return std::make_shared<Float>(a * b);
-                case TokenType::SLASH: return std::make_shared<Float>(a / b);
+    Value Interpreter::visit(Binary* expr) {
+        Value left = evaluate(expr->m_left);
+        Value right = evaluate(expr->m_right);
+
+        switch(expr->m_data_type.m_type) {
+            case TokenType::INT_TYPE: {
+                int a = left.m_int;
+                int b = right.m_int;
+                //+ - * wrap on overflow like the VM and the Optimizer's folding
+                switch(expr->m_op.m_type) {
+                    case TokenType::PLUS: return Value(int(unsigned(a) + unsigned(b)));
+                    case TokenType::MINUS: return Value(int(unsigned(a) - unsigned(b)));
+                    case TokenType::STAR: return Value(int(unsigned(a) * unsigned(b)));
+                    case TokenType::SLASH:
+                    case TokenType::MOD:
+                        if (b == 0) {
+                            add_error(expr->m_op, "Integer division by zero.");
+                            return Value(0);
+                        }
+                        if (a == INT_MIN && b == -1) {
+                            add_error(expr->m_op, "Integer division overflow.");
+                            return Value(0);
+                        }
+                        return Value(expr->m_op.m_type == TokenType::SLASH ? a / b : a % b);
+                    default: break;
+                }
+                break;
             }
-        }
-        if(dynamic_cast<String*>(left.get())) {
-            std::string a = dynamic_cast<String*>(left.get())->m_value;
-            std::string b = dynamic_cast<String*>(right.get())->m_value;
-            switch(expr->m_op.m_type) {
-                case TokenType::PLUS: return std::make_shared<String>(a + b);
+            case TokenType::FLOAT_TYPE: {
+                float a = left.m_float;
+                float b = right.m_float;
+                switch(expr->m_op.m_type) {
+                    case TokenType::PLUS: return Value(a + b);
+                    case TokenType::MINUS: return Value(a - b);
+                    case TokenType::STAR: return Value(a * b);
+                    case TokenType::SLASH: return Value(a / b);
+                    default: break;
+                }
+                break;
             }
+            case TokenType::STRING_TYPE:
+                return Value(std::make_shared<String>(left.as_string() + right.as_string()));
+            default:
+                break;
         }
 
+        return Value();
     }
 
-    std::shared_ptr<Object> Interpreter::visit(Group* expr) {
-        return expr->m_expr->accept(*this);
+    Value Interpreter::visit(Group* expr) {
+        return evaluate(expr->m_expr);
     }
 
-    std::shared_ptr<Object> Interpreter::visit(Literal* expr) {
-        switch(expr->m_token.m_type) {
-            case TokenType::FLOAT:
-                return std::make_shared<Float>(stof(expr->m_token.m_lexeme));
-            case TokenType::INT:
-                return std::make_shared<Int>(stoi(expr->m_token.m_lexeme));
-            case TokenType::STRING:
-                return std::make_shared<String>(expr->m_token.m_lexeme);
-            case TokenType::TRUE:
-                return std::make_shared<Bool>(true);
-            case TokenType::FALSE:
-                return std::make_shared<Bool>(false);
-            case TokenType::NIL:
-                return std::make_shared<Nil>();
-        }
+    Value Interpreter::visit(Literal* expr) {
+        return expr->m_value;
     }
 
-    std::shared_ptr<Object> Interpreter::visit(Logic* expr) {
-
-        std::shared_ptr<Object> left = expr->m_left->accept(*this);
-        std::shared_ptr<Object> right = expr->m_right->accept(*this);
-
-        Bool* bool_left = dynamic_cast<Bool*>(left.get());
-        Bool* bool_right = dynamic_cast<Bool*>(right.get());
-        if(bool_left && bool_right) {
-            switch(expr->m_op.m_type) {
-                case TokenType::OR:
-                    return std::make_shared<Bool>(bool_left->m_value || bool_right->m_value);
-                case TokenType::AND:
-                    return std::make_shared<Bool>(bool_left->m_value && bool_right->m_value);
-                case TokenType::EQUAL_EQUAL: 
-                    return std::make_shared<Bool>(bool_left->m_value == bool_right->m_value);
-                case TokenType::BANG_EQUAL:
-                    return std::make_shared<Bool>(bool_left->m_value != bool_right->m_value);
-            }
-        }
+    Value Interpreter::visit(Logic* expr) {
 
-        Int* int_left = dynamic_cast<Int*>(left.get());
-        Int* int_right = dynamic_cast<Int*>(right.get());
-        if(int_left && int_right) {
-            switch(expr->m_op.m_type) {
-                case TokenType::EQUAL_EQUAL:
-                    return std::make_shared<Bool>(int_left->m_value == int_right->m_value);
-                case TokenType::BANG_EQUAL:
-                    return std::make_shared<Bool>(int_left->m_value != int_right->m_value);
-                case TokenType::LESS:
-                    return std::make_shared<Bool>(int_left->m_value < int_right->m_value);
-                case TokenType::LESS_EQUAL:
-                    return std::make_shared<Bool>(int_left->m_value <= int_right->m_value);
-                case TokenType::GREATER:
-                    return std::make_shared<Bool>(int_left->m_value > int_right->m_value);
-                case TokenType::GREATER_EQUAL:
-                    return std::make_shared<Bool>(int_left->m_value >= int_right->m_value);
-            }
-        }
+        Value left = evaluate(expr->m_left);
 
-        Float* float_left   =   dynamic_cast<Float*>(left.get());
-        Float* float_right   =   dynamic_cast<Float*>(right.get());
-        if(float_left && float_right) {
-            switch(expr->m_op.m_type) {
-                case TokenType::EQUAL_EQUAL: 
-                    return std::make_shared<Bool>(abs(float_left->m_value - float_right->m_value) < 0.01f);
-                case TokenType::BANG_EQUAL:
-                    return std::make_shared<Bool>(abs(float_left->m_value - float_right->m_value) >= 0.01f);
-                case TokenType::LESS:
-                    return std::make_shared<Bool>(float_left->m_value < float_right->m_value);
-                case TokenType::LESS_EQUAL:
-                    return std::make_shared<Bool>(float_left->m_value < float_right->m_value ||
-                            abs(float_left->m_value - float_right->m_value) < 0.01f);
-                case TokenType::GREATER:
-                    return std::make_shared<Bool>(float_left->m_value > float_right->m_value);
-                case TokenType::GREATER_EQUAL:
-                    return std::make_shared<Bool>(float_left->m_value > float_right->m_value ||
-                            abs(float_left->m_value - float_right->m_value) < 0.01f);
-            }
+        //right side only runs if it can change the result
+        if (expr->m_op.m_type == TokenType::AND) {
+            return left.m_bool ? evaluate(expr->m_right) : left;
+        }
+        if (expr->m_op.m_type == TokenType::OR) {
+            return left.m_bool ? left : evaluate(expr->m_right);
         }
 
-        String* string_left =   dynamic_cast<String*>(left.get());
-        String* string_right =   dynamic_cast<String*>(right.get());
-        if(string_left && string_right) {
-            switch(expr->m_op.m_type) {
-                case TokenType::EQUAL_EQUAL: 
-                    return std::make_shared<Bool>(string_left->m_value == string_right->m_value);
-                case TokenType::BANG_EQUAL:
-                    return std::make_shared<Bool>(string_left->m_value != string_right->m_value);
-            }
+        Value right = evaluate(expr->m_right);
+
+        switch(expr->m_left->m_data_type.m_type) {
+            case TokenType::BOOL_TYPE:
+                switch(expr->m_op.m_type) {
+                    case TokenType::EQUAL_EQUAL: 
+                        return Value(left.m_bool == right.m_bool);
+                    case TokenType::BANG_EQUAL:
+                        return Value(left.m_bool != right.m_bool);
+                    default: break;
+                }
+                break;
+            case TokenType::INT_TYPE:
+                switch(expr->m_op.m_type) {
+                    case TokenType::EQUAL_EQUAL:
+                        return Value(left.m_int == right.m_int);
+                    case TokenType::BANG_EQUAL:
+                        return Value(left.m_int != right.m_int);
+                    case TokenType::LESS:
+                        return Value(left.m_int < right.m_int);
+                    case TokenType::LESS_EQUAL:
+                        return Value(left.m_int <= right.m_int);
+                    case TokenType::GREATER:
+                        return Value(left.m_int > right.m_int);
+                    case TokenType::GREATER_EQUAL:
+                        return Value(left.m_int >= right.m_int);
+                    default: break;
+                }
+                break;
+            case TokenType::FLOAT_TYPE:
+                switch(expr->m_op.m_type) {
+                    case TokenType::EQUAL_EQUAL: 
+                        return Value(std::abs(left.m_float - right.m_float) < 0.01f);
+                    case TokenType::BANG_EQUAL:
+                        return Value(std::abs(left.m_float - right.m_float) >= 0.01f);
+                    case TokenType::LESS:
+                        return Value(left.m_float < right.m_float);
+                    case TokenType::LESS_EQUAL:
+                        return Value(left.m_float < right.m_float ||
+                                std::abs(left.m_float - right.m_float) < 0.01f);
+                    case TokenType::GREATER:
+                        return Value(left.m_float > right.m_float);
+                    case TokenType::GREATER_EQUAL:
+                        return Value(left.m_float > right.m_float ||
+                                std::abs(left.m_float - right.m_float) < 0.01f);
+                    default: break;
+                }
+                break;
+            case TokenType::STRING_TYPE:
+                switch(expr->m_op.m_type) {
+                    case TokenType::EQUAL_EQUAL: 
+                        return Value(left.as_string() == right.as_string());
+                    case TokenType::BANG_EQUAL:
+                        return Value(left.as_string() != right.as_string());
+                    default: break;
+                }
+                break;
+            default:
+                break;
         }
 
+        return Value();
     }
 
     /*
      * Variables and Functions
      */
 
-    std::shared_ptr<Object> Interpreter::visit(DeclVar* expr) {
-        std::shared_ptr<Object> value = evaluate(expr->m_value.get());
-        m_environment->define(expr->m_name, value);
+    Value Interpreter::visit(DeclVar* expr) {
+        Value value = evaluate(expr->m_value);
+        m_environment->define(expr->m_slot, value);
         return value;
     }
 
-    std::shared_ptr<Object> Interpreter::visit(GetVar* expr) {
+    Value Interpreter::visit(GetVar* expr) {
         if (expr->m_env.m_type != TokenType::NIL) {
-            ClassInst* inst = dynamic_cast<ClassInst*>(m_environment->get(expr->m_env).get()); 
-            return inst->m_environment->get(expr->m_name);
+            ClassInst* inst = m_environment->get(expr->m_depth, expr->m_slot).as<ClassInst>(); 
+            return inst->m_fields->get(inst->m_class->field_slot(expr->m_name.m_symbol, expr->m_cache));
         }
 
-        return m_environment->get(expr->m_name);
+        return m_environment->get(expr->m_depth, expr->m_slot);
     }
 
-    std::shared_ptr<Object> Interpreter::visit(SetVar* expr) {
+    Value Interpreter::visit(SetVar* expr) {
         if (expr->m_env.m_type != TokenType::NIL) {
-            ClassInst* inst = dynamic_cast<ClassInst*>(m_environment->get(expr->m_env).get());
-            std::shared_ptr<Object> value = evaluate(expr->m_value.get());
-            inst->m_environment->assign(expr->m_name, value);
+            ClassInst* inst = m_environment->get(expr->m_depth, expr->m_slot).as<ClassInst>();
+            Value value = evaluate(expr->m_value);
+            inst->m_fields->define(inst->m_class->field_slot(expr->m_name.m_symbol, expr->m_cache), value);
             return value;
         }
-        std::shared_ptr<Object> value = evaluate(expr->m_value.get());
-        m_environment->assign(expr->m_name, value);
+        Value value = evaluate(expr->m_value);
+        m_environment->assign(expr->m_depth, expr->m_slot, value);
         return value;
     }
 
-    std::shared_ptr<Object> Interpreter::visit(DeclFun* expr) {
-        std::shared_ptr<Object> fun = std::make_shared<FunDef>(expr->m_parameters, expr->m_body);
-        m_environment->define(expr->m_name, fun);
+    Value Interpreter::visit(DeclFun* expr) {
+        Value fun = Value(std::make_shared<FunDef>(expr->m_parameters, expr->m_body, expr->m_slot_count));
+        m_environment->define(expr->m_slot, fun);
         return fun;
     }
 
 
-    std::shared_ptr<Object> Interpreter::visit(CallFun* expr) {
+    Value Interpreter::visit(CallFun* expr) {
         /*
          * Instance method
          */
         if (expr->m_env.m_type != TokenType::NIL) {
-            ClassInst* inst = dynamic_cast<ClassInst*>(m_environment->get(expr->m_env).get());
-            Callable* method = dynamic_cast<Callable*>(inst->m_environment->get(expr->m_name).get());
+            Value inst_value = m_environment->get(expr->m_depth, expr->m_slot);
+            ClassInst* inst = inst_value.as<ClassInst>();
+            Value method_value = inst->m_class->m_methods->get(inst->m_class->method_slot(expr->m_name.m_symbol, expr->m_cache));
+            FunDef* method = method_value.as<FunDef>();
 
             //evaluate call arguments
-            std::vector<std::shared_ptr<Object>> arguments;
-            for (std::shared_ptr<Expr> e: expr->m_arguments) {
-                arguments.push_back(evaluate(e.get()));
+            std::vector<Value> arguments;
+            for (Expr* e: expr->m_arguments) {
+                arguments.push_back(evaluate(e));
             }
+            if (m_error_flag) return Value();
 
-            //create new env pointing at instance env. with is_func set to true
-            std::shared_ptr<Environment> method_env = std::make_shared<Environment>(inst->m_environment, true);
+            //method frame closes over the instance fields
             std::shared_ptr<Environment> closure = m_environment;
-            m_environment = method_env;
+            m_environment = m_env_pool.acquire(inst->m_fields, true, method->m_slot_count);
 
-            std::shared_ptr<Object> return_value = method->call(arguments, this);
+            Value return_value = method->call(arguments, this);
 
+            m_env_pool.release(std::move(m_environment));
             m_environment = closure;
 
             return return_value;
@@ -259,36 +272,39 @@ namespace zebra {
         /*
          * Regular Function
          */
-        std::shared_ptr<Object> obj = m_environment->get(expr->m_name);
-        Callable* fun = dynamic_cast<Callable*>(obj.get());
+        //scoping is lexical, so the function closes over the frame its name was declared in
+        std::shared_ptr<Environment> decl_env = m_environment;
+        for (int i = 0; i < expr->m_depth; i++) {
+            decl_env = decl_env->get_closure();
+        }
+        Value obj = decl_env->get(expr->m_slot);
+        Callable* fun = obj.as<Callable>();
 
         //evaluate call arguments
-        std::vector<std::shared_ptr<Object>> arguments;
-        for (std::shared_ptr<Expr> e: expr->m_arguments) {
-            arguments.push_back(evaluate(e.get()));
+        std::vector<Value> arguments;
+        for (Expr* e: expr->m_arguments) {
+            arguments.push_back(evaluate(e));
         }
+        if (m_error_flag) return Value();
 
-        std::shared_ptr<Environment> block_env = std::make_shared<Environment>(m_environment, true);
+        FunDef* fun_def = dynamic_cast<FunDef*>(fun);
+        int slot_count = fun_def ? fun_def->m_slot_count : 0;
         std::shared_ptr<Environment> closure = m_environment;
-        m_environment = block_env;
+        m_environment = m_env_pool.acquire(decl_env, true, slot_count);
 
-        std::shared_ptr<Object> return_value = fun->call(arguments, this);
+        Value return_value = fun->call(arguments, this);
 
+        m_env_pool.release(std::move(m_environment));
         m_environment = closure;
 
         return return_value;
     } 
 
-    std::shared_ptr<Object> Interpreter::visit(Return* expr) {
-        if (expr->m_value) {
-            std::shared_ptr<Object> ret = evaluate(expr->m_value.get());
-            m_environment->set_return(ret);
-            return ret;
-        } else {
-            std::shared_ptr<Object> ret = std::make_shared<Nil>();
-            m_environment->set_return(ret);
-            return ret;
-        }
+    //the value is handed to the caller through m_return_value, while
+    //Completion::RETURN unwinds the statements still left in the function
+    Value Interpreter::visit(Return* expr) {
+        m_return_value = expr->m_value ? evaluate(expr->m_value) : Value();
+        return m_return_value;
     }
 
 
@@ -296,83 +312,132 @@ namespace zebra {
      * Control Flow
      */
 
-    std::shared_ptr<Object> Interpreter::visit(Block* expr) {
-        std::shared_ptr<Environment> block_env = std::make_shared<Environment>(m_environment, false);
-        std::shared_ptr<Environment> closure = m_environment;
-        m_environment = block_env;
-
-        for(std::shared_ptr<Expr> e: expr->m_expressions) {
-            evaluate(e.get());  
-            if (dynamic_cast<Return*>(e.get())) {
-                break;
-            }
-        } 
-
-        m_environment = closure;   
-
-        return std::make_shared<Nil>();
+    //control flow only produces nil when used as a value
+    Value Interpreter::visit(Block* expr) {
+        execute(expr);
+        return Value();
     }
 
-    std::shared_ptr<Object> Interpreter::visit(If* expr) {
-        std::shared_ptr<Object> condition = evaluate(expr->m_condition.get());
-        if(dynamic_cast<Bool*>(condition.get())->m_value) {
-            evaluate(expr->m_then_branch.get());                    
-        }else if(expr->m_else_branch) {
-            evaluate(expr->m_else_branch.get());
-        }
-
-        return std::make_shared<Nil>();
+    Value Interpreter::visit(If* expr) {
+        execute(expr);
+        return Value();
     }
 
-    std::shared_ptr<Object> Interpreter::visit(For* expr) {
-        if(expr->m_initializer) evaluate(expr->m_initializer.get());
-
-        while(expr->m_condition && dynamic_cast<Bool*>(evaluate(expr->m_condition.get()).get())->m_value) {
-            evaluate(expr->m_body.get());
-            if(expr->m_update) evaluate(expr->m_update.get()); //not using result of expression
-        }
-
-        return std::make_shared<Nil>();
+    Value Interpreter::visit(For* expr) {
+        execute(expr);
+        return Value();
     }
 
-    std::shared_ptr<Object> Interpreter::visit(While* expr) {
-        while(dynamic_cast<Bool*>(evaluate(expr->m_condition.get()).get())->m_value) {
-            evaluate(expr->m_body.get());
-        }
-
-        return std::make_shared<Nil>();
+    Value Interpreter::visit(While* expr) {
+        execute(expr);
+        return Value();
     }
 
     /*
      * Classes
      */
     
-    std::shared_ptr<Object> Interpreter::visit(DeclClass* expr) {
-        std::vector<std::pair<Token, std::shared_ptr<Object>>> fields;
-        for (std::shared_ptr<Expr> field: expr->m_fields) {
-            std::shared_ptr<Object> value = evaluate(field.get());
-            Token token = dynamic_cast<DeclVar*>(field.get())->m_name;
-            fields.push_back(std::pair<Token, std::shared_ptr<Object>>(token, value));
+    Value Interpreter::visit(DeclClass* expr) {
+        std::vector<std::pair<Token, Value>> fields;
+        for (Expr* field: expr->m_fields) {
+            DeclVar* field_decl = expr_cast<DeclVar>(field);
+            Value value = evaluate(field_decl->m_value);
+            fields.push_back(std::pair<Token, Value>(field_decl->m_name, value));
         }
 
-        std::vector<std::pair<Token, std::shared_ptr<Object>>> methods;
-        for (std::shared_ptr<Expr> method: expr->m_methods) {
-            DeclFun* method_decl = dynamic_cast<DeclFun*>(method.get());
-            std::shared_ptr<Object> fun = std::make_shared<FunDef>(method_decl->m_parameters, method_decl->m_body);
-            methods.push_back(std::pair<Token, std::shared_ptr<Object>>(method_decl->m_name, fun));
+        std::vector<std::pair<Token, Value>> methods;
+        for (Expr* method: expr->m_methods) {
+            DeclFun* method_decl = expr_cast<DeclFun>(method);
+            Value fun = Value(std::make_shared<FunDef>(method_decl->m_parameters, method_decl->m_body, method_decl->m_slot_count));
+            methods.push_back(std::pair<Token, Value>(method_decl->m_name, fun));
         }
 
         //base is a pointer to base class Object (ClassDef)
-        std::shared_ptr<Object> base = nullptr;
+        std::shared_ptr<ClassDef> base = nullptr;
         if (expr->m_base.m_type != TokenType::NIL) {
-            base = m_environment->get(expr->m_base);
+            base = std::dynamic_pointer_cast<ClassDef>(m_environment->get(expr->m_base_depth, expr->m_base_slot).m_object);
         }
 
-        std::shared_ptr<Object> class_def = std::make_shared<ClassDef>(base, fields, methods);
-        m_environment->define(expr->m_name, class_def);
+        Value class_def = Value(std::make_shared<ClassDef>(base, fields, methods, m_global));
+        m_environment->define(expr->m_slot, class_def);
 
         return class_def;
     }
-   
+
+
+    /*
+     * Statements
+     */
+
+    //expressions in statement position are evaluated for their side effects only
+    Completion Interpreter::exec(Unary* expr) { evaluate(expr); return Completion::NORMAL; }
+    Completion Interpreter::exec(Binary* expr) { evaluate(expr); return Completion::NORMAL; }
+    Completion Interpreter::exec(Group* expr) { evaluate(expr); return Completion::NORMAL; }
+    Completion Interpreter::exec(Literal*) { return Completion::NORMAL; }
+    Completion Interpreter::exec(Logic* expr) { evaluate(expr); return Completion::NORMAL; }
+
+    Completion Interpreter::exec(DeclVar* expr) { evaluate(expr); return Completion::NORMAL; }
+    Completion Interpreter::exec(GetVar*) { return Completion::NORMAL; }
+    Completion Interpreter::exec(SetVar* expr) { evaluate(expr); return Completion::NORMAL; }
+    Completion Interpreter::exec(DeclFun* expr) { evaluate(expr); return Completion::NORMAL; }
+    Completion Interpreter::exec(CallFun* expr) { evaluate(expr); return Completion::NORMAL; }
+    Completion Interpreter::exec(DeclClass* expr) { evaluate(expr); return Completion::NORMAL; }
+
+    Completion Interpreter::exec(Return* expr) {
+        evaluate(expr);
+        return Completion::RETURN;
+    }
+
+    Completion Interpreter::exec(Block* expr) {
+        std::shared_ptr<Environment> closure = m_environment;
+        m_environment = m_env_pool.acquire(closure, false, expr->m_slot_count);
+
+        Completion completion = Completion::NORMAL;
+        for(Expr* e: expr->m_expressions) {
+            completion = execute(e);
+            if (completion == Completion::RETURN) {
+                break;
+            }
+        } 
+
+        m_env_pool.release(std::move(m_environment));
+        m_environment = closure;   
+
+        return completion;
+    }
+
+    Completion Interpreter::exec(If* expr) {
+        Value condition = evaluate(expr->m_condition);
+        if(condition.m_bool) {
+            return execute(expr->m_then_branch);                    
+        }else if(expr->m_else_branch) {
+            return execute(expr->m_else_branch);
+        }
+
+        return Completion::NORMAL;
+    }
+
+    Completion Interpreter::exec(For* expr) {
+        if(expr->m_initializer) execute(expr->m_initializer);
+
+        while(expr->m_condition && evaluate(expr->m_condition).m_bool) {
+            if (execute(expr->m_body) == Completion::RETURN) {
+                return Completion::RETURN;
+            }
+            if(expr->m_update) execute(expr->m_update);
+        }
+
+        return Completion::NORMAL;
+    }
+
+    Completion Interpreter::exec(While* expr) {
+        while(evaluate(expr->m_condition).m_bool) {
+            if (execute(expr->m_body) == Completion::RETURN) {
+                return Completion::RETURN;
+            }
+        }
+
+        return Completion::NORMAL;
+    }
 
 }
@@ -6,56 +6,74 @@
 #include "Expr.hpp"
 #include "Environment.hpp"
 #include "ResultCode.hpp"
+#include "RuntimeError.hpp"
 
 namespace zebra {
 
     class Object;
 
 
-    struct RuntimeError {
-        Token m_token;
-        std::string m_message;
-        RuntimeError(Token token, const std::string& message): m_token(token), m_message(message) {}
-        void print() {
-            std::cout << "[Line " << m_token.m_line << "] Runtime Error: " << m_message << std::endl;
-        }
-    };
-
-
-    class Interpreter: public ExprObjectVisitor {
+    /*
+     * Expressions are evaluated through visit().  Anything in statement position is run
+     * through exec() instead, so control flow never builds values nobody reads.
+     */
+    class Interpreter {
         private:
-            bool m_error_flag;
+            bool m_error_flag {false};
             std::vector<RuntimeError> m_errors;
+            EnvironmentPool m_env_pool;
         public:
             std::shared_ptr<Environment> m_environment;
             std::shared_ptr<Environment> m_global;
+            Value m_return_value;
         public:
             Interpreter();
             ~Interpreter();
-            ResultCode run(const std::vector<std::shared_ptr<Expr>> expressions);
+            ResultCode run(const std::vector<Expr*>& expressions);
             std::vector<RuntimeError> get_errors() const;
             void add_error(Token token, const std::string& message);
-            std::shared_ptr<Object> evaluate(Expr* expr);
-
-            std::shared_ptr<Object> visit(Unary* expr);
-            std::shared_ptr<Object> visit(Binary* expr);
-            std::shared_ptr<Object> visit(Group* expr);
-            std::shared_ptr<Object> visit(Literal* expr);
-            std::shared_ptr<Object> visit(Logic* expr);
-
-            std::shared_ptr<Object> visit(DeclVar* expr);
-            std::shared_ptr<Object> visit(GetVar* expr);
-            std::shared_ptr<Object> visit(SetVar* expr);
-            std::shared_ptr<Object> visit(DeclFun* expr);
-            std::shared_ptr<Object> visit(CallFun* expr);
-            std::shared_ptr<Object> visit(Return* expr);
-
-            std::shared_ptr<Object> visit(Block* expr);
-            std::shared_ptr<Object> visit(If* expr);
-            std::shared_ptr<Object> visit(For* expr);
-            std::shared_ptr<Object> visit(While* expr);
-
-            std::shared_ptr<Object> visit(DeclClass* expr);
+            Value evaluate(Expr* expr);
+            Completion execute(Expr* expr);
+
+            Value visit(Unary* expr);
+            Value visit(Binary* expr);
+            Value visit(Group* expr);
+            Value visit(Literal* expr);
+            Value visit(Logic* expr);
+
+            Value visit(DeclVar* expr);
+            Value visit(GetVar* expr);
+            Value visit(SetVar* expr);
+            Value visit(DeclFun* expr);
+            Value visit(CallFun* expr);
+            Value visit(Return* expr);
+
+            Value visit(Block* expr);
+            Value visit(If* expr);
+            Value visit(For* expr);
+            Value visit(While* expr);
+
+            Value visit(DeclClass* expr);
+
+            Completion exec(Unary* expr);
+            Completion exec(Binary* expr);
+            Completion exec(Group* expr);
+            Completion exec(Literal* expr);
+            Completion exec(Logic* expr);
+
+            Completion exec(DeclVar* expr);
+            Completion exec(GetVar* expr);
+            Completion exec(SetVar* expr);
+            Completion exec(DeclFun* expr);
+            Completion exec(CallFun* expr);
+            Completion exec(Return* expr);
+
+            Completion exec(Block* expr);
+            Completion exec(If* expr);
+            Completion exec(For* expr);
+            Completion exec(While* expr);
+
+            Completion exec(DeclClass* expr);
     };
 
 }
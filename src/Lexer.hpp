@@ -2,13 +2,16 @@
 #define ZEBRA_LEXER_H
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <iostream>
 #include <fstream>
+#include <filesystem>
 #include <assert.h>
 
 #include "Token.hpp"
 #include "ResultCode.hpp"
+#include "Scan.hpp"
 
 namespace zebra {
 
@@ -17,17 +20,35 @@ namespace zebra {
         int m_line;
         std::string m_message;
         SyntaxError(int line, const std::string& message): m_line(line), m_message(message) {}
-        void print() {
-            std::cout << "[Line " << m_line << "] Syntax Error: " << m_message << std::endl;
+        void print(std::ostream& out = std::cout) {
+            out << "[Line " << m_line << "] Syntax Error: " << m_message << std::endl;
+        }
+    };
+
+    struct SourceError {
+        std::string m_path;
+        std::string m_message;
+        SourceError(const std::string& path, const std::string& message): m_path(path), m_message(message) {}
+        void print(std::ostream& out = std::cout) {
+            out << "Source Error: " << m_path << ": " << m_message << std::endl;
         }
     };
 
     class Lexer {
+        public:
+            struct Slice {
+                size_t m_begin;
+                size_t m_end;
+                int m_line; //line the slice starts on
+            };
         private:
-            std::string m_source = "";
+            std::string m_buffer = ""; //owned source text, empty for a Lexer over a slice of another's
+            std::string_view m_source; //text being scanned, always ending in a newline
             int m_current = 0;
             int m_line = 1;
             std::vector<SyntaxError> m_errors;
+            std::vector<Token> m_pending; //tokens from the last lexeme not yet handed out by next_token()
+            int m_pending_current = 0;
         public:
             static void print_tokens(const std::vector<Token>& tokens) {
                 for (Token t: tokens) {
@@ -36,15 +57,30 @@ namespace zebra {
             }
 
         public:
-            Lexer(const char* file_path) {
-                read_source(file_path);
+            Lexer() {}
+
+            //source held in memory by the caller, copied so tokens can outlive it
+            Lexer(std::string_view source): m_buffer(source) {
+                terminate_source();
             }
 
+            //scans [begin, end) of another Lexer's source, starting on the given line - end must
+            //follow a newline.  Tokens view the other Lexer's buffer, which must outlive them
+            Lexer(const Lexer& whole, size_t begin, size_t end, int line): m_source(whole.m_source.substr(begin, end - begin)), m_line(line) {
+                assert(m_source.empty() || m_source.back() == '\n');
+            }
+
+            Lexer(const Lexer&) = delete;
+            Lexer& operator=(const Lexer&) = delete;
+
             ~Lexer() {}
 
             ResultCode scan(std::vector<Token>& tokens) {
                 m_errors.clear();
-                scan_source(tokens);
+                while (!is_at_end()) {
+                    scan_token(tokens);
+                }
+                add_token(tokens, TokenType::EOFILE);
 
                 if (m_errors.empty())
                     return ResultCode::SUCCESS;
@@ -52,223 +88,320 @@ namespace zebra {
                     return ResultCode::FAILED;
             }
 
+            //whole file is read in one go into a buffer sized to fit it
+            ResultCode read_file(const char* file_path, std::vector<SourceError>& errors) {
+                std::error_code ec;
+                uintmax_t size = std::filesystem::file_size(file_path, ec);
+                if (ec) {
+                    errors.emplace_back(file_path, ec.message());
+                    return ResultCode::FAILED;
+                }
+
+                std::ifstream file(file_path, std::ios::binary);
+                m_buffer.resize(size_t(size));
+                if (!file.read(m_buffer.data(), std::streamsize(size))) {
+                    m_buffer.clear();
+                    m_source = m_buffer;
+                    errors.emplace_back(file_path, "Could not read file");
+                    return ResultCode::FAILED;
+                }
+
+                terminate_source();
+                return ResultCode::SUCCESS;
+            }
+
+            std::string_view source() const {
+                return m_source;
+            }
+
             void print_source() const {
                 std::cout << m_source;
             }
 
+            //pull interface used by the Parser; keeps returning EOFILE once the source is used up
+            Token next_token() {
+                while (m_pending_current == int(m_pending.size())) {
+                    m_pending.clear();
+                    m_pending_current = 0;
+                    if (is_at_end()) {
+                        add_token(m_pending, TokenType::EOFILE);
+                    } else {
+                        scan_token(m_pending);
+                    }
+                }
+                return m_pending[m_pending_current++];
+            }
+
             std::vector<SyntaxError> get_errors() {
                 return m_errors;
             }
-        private:
-            void scan_source(std::vector<Token>& tokens) {
-                while (!is_at_end()) {
-                    char c = next();
-                    switch(c) {
-                        //single char tokens
-                        case '+': add_token(tokens, TokenType::PLUS); break;
-                        case '-': 
-                            if(match('>')) add_token(tokens, TokenType::RIGHT_ARROW);
-                            else add_token(tokens, TokenType::MINUS); 
-                            break;
-                        case '/': 
-                            if(match('/'))  advance_to_next_line();
-                            else            add_token(tokens, TokenType::SLASH);
-                            break;
-                        case '*': add_token(tokens, TokenType::STAR); break;
-                        case ';': add_token(tokens, TokenType::SEMICOLON); break;
-                        case '(': add_token(tokens, TokenType::LEFT_PAREN); break;
-                        case ')': add_token(tokens, TokenType::RIGHT_PAREN); break;
-                        case '{': add_token(tokens, TokenType::LEFT_BRACE); break;
-                        case '}': add_token(tokens, TokenType::RIGHT_BRACE); break;
-                        case '%': add_token(tokens, TokenType::MOD); break;
-                        case ',': add_token(tokens, TokenType::COMMA); break;
-                        case ':': 
-                            if (match(':')) add_token(tokens, TokenType::COLON_COLON);
-                            else            add_token(tokens, TokenType::COLON);
-                            break;
-                        case '.': 
-                            if (is_numeric(peek())) {
-                                int start = m_current - 1;
-                                while(!is_at_end() && is_numeric(peek())) {
-                                    next();
-                                }
-                                int len = m_current - start;
-                                add_token(tokens, TokenType::FLOAT, m_source.substr(start, len));
-                            } else {                     
-                                add_token(tokens, TokenType::DOT); 
+
+            //cuts the source into slices of at least min_size bytes, only where a line starting a
+            //declaration ('name:' or 'name ::') sits outside any braces, parentheses, strings and comments
+            std::vector<Slice> split(size_t min_size) const {
+                std::vector<Slice> slices;
+                const char* data = m_source.data();
+                size_t end = m_source.size();
+                size_t begin = 0;
+                int begin_line = m_line;
+                int line = m_line;
+                int depth = 0;
+
+                size_t pos = 0;
+                while (pos < end) {
+                    switch(data[pos]) {
+                        case '"':
+                            pos++;
+                            while (true) {
+                                pos = scan::find_special(data, pos, end, '"', '\n');
+                                if (pos >= end || data[pos] == '"') break;
+                                if (data[pos] == '\n') line++;
+                                pos++;
                             }
+                            pos++;
                             break;
-                        //double or single char tokens
-                        case '=':
-                            if (match('=')) add_token(tokens, TokenType::EQUAL_EQUAL);
-                            else            add_token(tokens, TokenType::EQUAL);
-                            break;
-                        case '<':
-                            if (match('=')) add_token(tokens, TokenType::LESS_EQUAL);
-                            else            add_token(tokens, TokenType::LESS);
-                            break;
-                        case '>':
-                            if (match('=')) add_token(tokens, TokenType::GREATER_EQUAL);
-                            else            add_token(tokens, TokenType::GREATER);
-                            break;
-                        case '!':
-                            if (match('=')) add_token(tokens, TokenType::BANG_EQUAL);
-                            else            add_token(tokens, TokenType::BANG);
-                            break;
-                        //literals, keywords, and eofile
-                        case '"': 
-                            add_token(tokens, TokenType::STRING, read_string());
-                            break;
-                        case '\n': m_line++;
-                        case '\r':
-                        case ' ':
-                            break;
-                        case 'a':
-                            if (match("nd")) add_token(tokens, TokenType::AND);
-                            else add_token(tokens, TokenType::IDENTIFIER, read_identifier());
-                            break;
-                        case 'b':
-                            if (match("ool")) add_token(tokens, TokenType::BOOL_TYPE);
-                            else add_token(tokens, TokenType::IDENTIFIER, read_identifier());
-                            break;
-                        case 'c':
-                            if (match("lass")) add_token(tokens, TokenType::CLASS);
-                            else add_token(tokens, TokenType::IDENTIFIER, read_identifier());
-                            break;
-                        case 'e':
-                            if (match("lse")) add_token(tokens, TokenType::ELSE);
-                            else add_token(tokens, TokenType::IDENTIFIER, read_identifier());
-                            break;
-                        case 'f':
-                            if (match("alse")) add_token(tokens, TokenType::FALSE);
-                            else if(match("loat")) add_token(tokens, TokenType::FLOAT_TYPE);
-                            else if(match("or")) add_token(tokens, TokenType::FOR);
-                            else if(match("un")) add_token(tokens, TokenType::FUN_TYPE);
-                            else add_token(tokens, TokenType::IDENTIFIER, read_identifier());
-                            break;
-                        case 'i':
-                            if (match("f")) add_token(tokens, TokenType::IF);
-                            else if(match("nt")) add_token(tokens, TokenType::INT_TYPE);
-                            else if(match("mport")) add_token(tokens, TokenType::IMPORT);
-                            else add_token(tokens, TokenType::IDENTIFIER, read_identifier());
-                            break;
-                        case 'o':
-                            if (match("r")) add_token(tokens, TokenType::OR);
-                            else add_token(tokens, TokenType::IDENTIFIER, read_identifier());
-                            break;
-                        case 'n':
-                            if (match("il")) add_token(tokens, TokenType::NIL_TYPE);
-                            else add_token(tokens, TokenType::IDENTIFIER, read_identifier());
-                            break;
-                        case 'r':
-                            if (match("eturn")) {
-                                add_token(tokens, TokenType::RETURN);
-                                if (peek() == ';') { //this really should be here - parser should take care of this
-                                    add_token(tokens, TokenType::NIL);
-                                }
+                        case '/':
+                            pos++;
+                            if (pos < end && data[pos] == '/') {
+                                //stops on the newline, which is counted below
+                                do {
+                                    pos = scan::find_special(data, pos + 1, end, '\n', '\n');
+                                } while (pos < end && data[pos] != '\n');
                             }
-                            else add_token(tokens, TokenType::IDENTIFIER, read_identifier());
                             break;
-                        case 's':
-                            if (match("tring")) add_token(tokens, TokenType::STRING_TYPE);
-                            else add_token(tokens, TokenType::IDENTIFIER, read_identifier());
+                        case '{':
+                        case '(':
+                            depth++;
+                            pos++;
                             break;
-                        case 't':
-                            if (match("rue")) add_token(tokens, TokenType::TRUE);
-                            else add_token(tokens, TokenType::IDENTIFIER, read_identifier());
+                        case '}':
+                        case ')':
+                            if (depth > 0) depth--;
+                            pos++;
                             break;
-                        case 'w':
-                            if (match("hile")) add_token(tokens, TokenType::WHILE);
-                            else add_token(tokens, TokenType::IDENTIFIER, read_identifier());
+                        case '\n':
+                            line++;
+                            pos++;
+                            if (depth == 0 && pos - begin >= min_size && pos < end && starts_declaration(pos)) {
+                                slices.push_back({begin, pos, begin_line});
+                                begin = pos;
+                                begin_line = line;
+                            }
                             break;
                         default:
-                            if (is_numeric(c)) {
-                                int start = m_current - 1;
-                                while(!is_at_end() && is_numeric(peek())) {
-                                    next();
-                                }
+                            pos++;
+                            break;
+                    }
+                }
 
-                                if (is_at_end()) {
-                                    int len = m_current - start;
-                                    add_token(tokens, TokenType::INT, m_source.substr(start, len));
-                                } else if (!is_at_end() && peek() != '.') {
-                                    int len = m_current - start;
-                                    add_token(tokens, TokenType::INT, m_source.substr(start, len));
-                                } else {
-                                    if (!is_at_end() && peek() == '.') {
-                                        next();               
-                                        while(!is_at_end() && is_numeric(peek())) {
-                                            next();
-                                        }
-                                    }
+                slices.push_back({begin, end, begin_line});
+                return slices;
+            }
+        private:
+            //scans a single lexeme, which may add zero (whitespace, comments), one or two tokens
+            void scan_token(std::vector<Token>& tokens) {
+                char c = next();
+                switch(c) {
+                    //single char tokens
+                    case '+': add_token(tokens, TokenType::PLUS); break;
+                    case '-': 
+                        if(match('>')) add_token(tokens, TokenType::RIGHT_ARROW);
+                        else add_token(tokens, TokenType::MINUS); 
+                        break;
+                    case '/': 
+                        if(match('/'))  advance_to_next_line();
+                        else            add_token(tokens, TokenType::SLASH);
+                        break;
+                    case '*': add_token(tokens, TokenType::STAR); break;
+                    case ';': add_token(tokens, TokenType::SEMICOLON); break;
+                    case '(': add_token(tokens, TokenType::LEFT_PAREN); break;
+                    case ')': add_token(tokens, TokenType::RIGHT_PAREN); break;
+                    case '{': add_token(tokens, TokenType::LEFT_BRACE); break;
+                    case '}': add_token(tokens, TokenType::RIGHT_BRACE); break;
+                    case '%': add_token(tokens, TokenType::MOD); break;
+                    case ',': add_token(tokens, TokenType::COMMA); break;
+                    case ':': 
+                        if (match(':')) add_token(tokens, TokenType::COLON_COLON);
+                        else            add_token(tokens, TokenType::COLON);
+                        break;
+                    case '.': 
+                        if (is_numeric(peek())) {
+                            int start = m_current - 1;
+                            while(!is_at_end() && is_numeric(peek())) {
+                                next();
+                            }
+                            int len = m_current - start;
+                            add_token(tokens, TokenType::FLOAT, start, len);
+                        } else {                     
+                            add_token(tokens, TokenType::DOT); 
+                        }
+                        break;
+                    //double or single char tokens
+                    case '=':
+                        if (match('=')) add_token(tokens, TokenType::EQUAL_EQUAL);
+                        else            add_token(tokens, TokenType::EQUAL);
+                        break;
+                    case '<':
+                        if (match('=')) add_token(tokens, TokenType::LESS_EQUAL);
+                        else            add_token(tokens, TokenType::LESS);
+                        break;
+                    case '>':
+                        if (match('=')) add_token(tokens, TokenType::GREATER_EQUAL);
+                        else            add_token(tokens, TokenType::GREATER);
+                        break;
+                    case '!':
+                        if (match('=')) add_token(tokens, TokenType::BANG_EQUAL);
+                        else            add_token(tokens, TokenType::BANG);
+                        break;
+                    //literals, keywords, and eofile
+                    case '"': 
+                        read_string(tokens);
+                        break;
+                    case '\n':
+                        m_line++;
+                        [[fallthrough]];
+                    case '\r':
+                    case ' ':
+                        m_current = int(scan::skip_blanks(m_source.data(), m_current, scan_end()));
+                        break;
+                    default:
+                        if (is_numeric(c)) {
+                            int start = m_current - 1;
+                            while(!is_at_end() && is_numeric(peek())) {
+                                next();
+                            }
 
-                                    int len = m_current - start;
-                                    add_token(tokens, TokenType::FLOAT, m_source.substr(start, len));
-                                }
-                            } else if (is_alpha(c)) {
-                                add_token(tokens, TokenType::IDENTIFIER, read_identifier());
+                            if (is_at_end()) {
+                                int len = m_current - start;
+                                add_token(tokens, TokenType::INT, start, len);
+                            } else if (!is_at_end() && peek() != '.') {
+                                int len = m_current - start;
+                                add_token(tokens, TokenType::INT, start, len);
                             } else {
-                                m_errors.emplace_back(m_line, "Unrecognized character.");
+                                if (!is_at_end() && peek() == '.') {
+                                    next();               
+                                    while(!is_at_end() && is_numeric(peek())) {
+                                        next();
+                                    }
+                                }
+
+                                int len = m_current - start;
+                                add_token(tokens, TokenType::FLOAT, start, len);
                             }
-                            break;
-                    }
+                        } else if (is_alpha(c)) {
+                            read_word(tokens);
+                        } else {
+                            m_errors.emplace_back(m_line, "Unrecognized character.");
+                        }
+                        break;
                 }
-                add_token(tokens, TokenType::EOFILE);
             }
 
+            //comment text is skipped in blocks, stopping only at the newline or to validate non-ASCII bytes
             void advance_to_next_line() {
-                while(!is_at_end() && peek() != '\n') {
-                    next();
+                size_t end = scan_end();
+                size_t pos = m_current;
+                while (true) {
+                    pos = scan::find_special(m_source.data(), pos, end, '\n', '\n');
+                    if (pos >= end || m_source[pos] == '\n') break;
+                    pos = skip_utf8(pos, end);
+                }
+                m_current = int(pos);
+            }
+
+            //steps over the UTF-8 sequence at pos, or a single byte if it is malformed
+            size_t skip_utf8(size_t pos, size_t end) {
+                int len = scan::utf8_sequence_length(m_source.data(), pos, end);
+                if (len == 0) {
+                    m_errors.emplace_back(m_line, "Invalid UTF-8 sequence.");
+                    return pos + 1;
                 }
+                return pos + len;
             }
 
-            void add_token(std::vector<Token>& tokens, TokenType type, const std::string& lexeme) {
-                tokens.emplace_back(Token(type, lexeme, m_line));
+            //tokens refer to their lexeme by position in m_source rather than copying it
+            void add_token(std::vector<Token>& tokens, TokenType type, int start, int len) {
+                tokens.emplace_back(type, m_source.data() + start, uint32_t(len), m_line);
             }
 
+            //no lexeme, but the position just past the token is kept so scanning can restart there
             void add_token(std::vector<Token>& tokens, TokenType type) {
-                tokens.emplace_back(Token(type, "", m_line));
+                tokens.emplace_back(type, m_source.data() + m_current, 0, m_line);
             }
 
-            std::string read_string() {
+            void read_string(std::vector<Token>& tokens) {
                 int start = m_current; //not including quote
-                while(!is_at_end() && peek() != '"') {
-                    next();
+                size_t end = scan_end();
+                size_t pos = m_current;
+                while (true) {
+                    pos = scan::find_special(m_source.data(), pos, end, '"', '\n');
+                    if (pos >= end || m_source[pos] == '"') break;
+                    if (m_source[pos] == '\n') {
+                        m_line++;
+                        pos++;
+                    } else {
+                        pos = skip_utf8(pos, end);
+                    }
                 }
+                m_current = int(pos);
 
                 if (peek() != '"') m_errors.emplace_back(m_line, "Unclosed double quotes.");
 
                 next();
 
                 int len = m_current - start - 1; //removing two quotes, but adding on extra space for null terminater
-                return m_source.substr(start, len);
+                add_token(tokens, TokenType::STRING, start, len);
             }
             
 
-            std::string read_identifier() {
+            //keywords and identifiers share one scan, then the span is classified in place
+            void read_word(std::vector<Token>& tokens) {
                 int start = m_current - 1;
-                while(!is_at_end() && is_alpha_numeric(peek())) {
-                    next();
-                }
+                m_current = int(scan::skip_identifier(m_source.data(), m_current, scan_end()));
 
                 int len = m_current - start;
-                return m_source.substr(start, len);
-            }
+                std::string_view word(m_source.data() + start, len);
+                TokenType type = keyword_type(word);
 
-            bool match(const std::string& s) {
-
-                if (s != m_source.substr(m_current, s.length())) {
-                    return false;
+                if (type == TokenType::IDENTIFIER) {
+                    add_token(tokens, TokenType::IDENTIFIER, start, len);
+                    tokens.back().m_symbol = Symbols::intern(word);
+                    return;
                 }
 
-                //check that next char is also not a letter
-                if (is_alpha(char(m_source.at(m_current + s.length())))) {
-                    return false;
+                add_token(tokens, type);
+                if (type == TokenType::RETURN && peek() == ';') { //this really should be here - parser should take care of this
+                    add_token(tokens, TokenType::NIL);
                 }
+            }
 
-                for (int i = 0; i < (int)(s.length()); i++) next();
-
-                return true;
+            //branches on the first character, then compares against the few keywords left
+            static constexpr TokenType keyword_type(std::string_view word) {
+                switch(word[0]) {
+                    case 'a': if (word == "and") return TokenType::AND; break;
+                    case 'b': if (word == "bool") return TokenType::BOOL_TYPE; break;
+                    case 'c': if (word == "class") return TokenType::CLASS; break;
+                    case 'e': if (word == "else") return TokenType::ELSE; break;
+                    case 'f':
+                        if (word == "false") return TokenType::FALSE;
+                        if (word == "float") return TokenType::FLOAT_TYPE;
+                        if (word == "for") return TokenType::FOR;
+                        if (word == "fun") return TokenType::FUN_TYPE;
+                        break;
+                    case 'i':
+                        if (word == "if") return TokenType::IF;
+                        if (word == "int") return TokenType::INT_TYPE;
+                        if (word == "import") return TokenType::IMPORT;
+                        break;
+                    case 'n': if (word == "nil") return TokenType::NIL_TYPE; break;
+                    case 'o': if (word == "or") return TokenType::OR; break;
+                    case 'r': if (word == "return") return TokenType::RETURN; break;
+                    case 's': if (word == "string") return TokenType::STRING_TYPE; break;
+                    case 't': if (word == "true") return TokenType::TRUE; break;
+                    case 'w': if (word == "while") return TokenType::WHILE; break;
+                    default: break;
+                }
+                return TokenType::IDENTIFIER;
             }
 
             bool match(char c) {
@@ -293,29 +426,35 @@ namespace zebra {
                 return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
             }
 
-            bool is_alpha_numeric(char c) {
-                return (is_alpha(c) || is_numeric(c));
-            }
-
             bool is_at_end() {
                 return m_current >= int(m_source.length() - 1);
             }
 
-            bool is_numeric(char c) {
-                return c >= '0' && c <= '9';
+            bool starts_declaration(size_t pos) const {
+                const char* data = m_source.data();
+                size_t end = m_source.size();
+                pos = scan::skip_blanks(data, pos, end);
+                if (pos >= end || !scan::is_identifier_char(data[pos]) || is_numeric(data[pos])) return false;
+                pos = scan::skip_identifier(data, pos, end);
+                pos = scan::skip_blanks(data, pos, end);
+                return pos < end && data[pos] == ':';
             }
 
-            void read_source(const char* file_path) {
-                std::string line;
-                std::ifstream my_file(file_path);
+            //scans stop short of the terminating newline, matching is_at_end()
+            size_t scan_end() const {
+                return m_source.empty() ? 0 : m_source.length() - 1;
+            }
 
-                if(my_file.is_open()) {
-                    while (getline(my_file, line)) {
-                      m_source += line + "\n";
-                    }
-                    my_file.close();
-                }
+            static bool is_numeric(char c) {
+                return c >= '0' && c <= '9';
+            }
 
+            //scanning relies on the source ending in a newline
+            void terminate_source() {
+                if (!m_buffer.empty() && m_buffer.back() != '\n') {
+                    m_buffer.push_back('\n');
+                }
+                m_source = m_buffer;
             }
 
     };
@@ -10,40 +10,29 @@ namespace zebra {
     class Print: public Callable {
         public:
             Print(): Callable({DataType(TokenType::STRING_TYPE), DataType(TokenType::NIL_TYPE)}) {}
-            virtual std::shared_ptr<Object> call(std::vector<std::shared_ptr<Object>> arguments, Interpreter* interp) override {
-                std::shared_ptr<Object> value = arguments.at(0);
-
-                if(dynamic_cast<Bool*>(value.get())) {
-                    std::cout << dynamic_cast<Bool*>(value.get())->m_value << std::endl;
-                }
-                if(dynamic_cast<Int*>(value.get())) {
-                    std::cout << dynamic_cast<Int*>(value.get())->m_value << std::endl;
-                }
-                if(dynamic_cast<Float*>(value.get())) {
-                    std::cout << dynamic_cast<Float*>(value.get())->m_value << std::endl;
-                }
-                if(dynamic_cast<String*>(value.get())) {
-                    std::cout << dynamic_cast<String*>(value.get())->m_value << std::endl;
+            virtual Value call(const std::vector<Value>& arguments, Interpreter* interp) override {
+                const Value& value = arguments.at(0);
+
+                switch(value.m_type) {
+                    case ValueType::BOOL: std::cout << value.m_bool << std::endl; break;
+                    case ValueType::INT: std::cout << value.m_int << std::endl; break;
+                    case ValueType::FLOAT: std::cout << value.m_float << std::endl; break;
+                    case ValueType::STRING: std::cout << value.as_string() << std::endl; break;
+                    default: break;
                 }
 
-                return std::make_shared<Nil>();
-            }
-            std::shared_ptr<Object> clone() override {
-                return std::make_shared<Print>(*this);
+                return Value();
             }
     };
 
     class Input: public Callable {
         public:
             Input(): Callable({DataType(TokenType::STRING_TYPE)}) {}
-            virtual std::shared_ptr<Object> call(std::vector<std::shared_ptr<Object>> arguments, Interpreter* interp) override {
+            virtual Value call(const std::vector<Value>& arguments, Interpreter* interp) override {
                 std::string line;
                 std::getline(std::cin, line);
 
-                return std::make_shared<String>(line);
-            }
-            std::shared_ptr<Object> clone() override {
-                return std::make_shared<Input>(*this);
+                return Value(std::make_shared<String>(line));
             }
     };
 
@@ -51,16 +40,22 @@ namespace zebra {
     class Clock: public Callable {
         public:
             Clock(): Callable({DataType(TokenType::FLOAT_TYPE)}) {}
-            virtual std::shared_ptr<Object> call(std::vector<std::shared_ptr<Object>> arguments, Interpreter* interp) override {
+            virtual Value call(const std::vector<Value>& arguments, Interpreter* interp) override {
                 std::chrono::high_resolution_clock::time_point time = std::chrono::high_resolution_clock::now();
                 double seconds = std::chrono::duration<double>(time.time_since_epoch()).count();
-                return std::make_shared<Float>(float(seconds));
-            }
-            std::shared_ptr<Object> clone() override {
-                return std::make_shared<Clock>(*this);
+                return Value(float(seconds));
             }
     };
 
+    //natives occupy the first slots of the global frame, in this order
+    inline std::vector<std::pair<std::string, std::shared_ptr<Callable>>> native_functions() {
+        return {
+            {"print", std::make_shared<Print>()},
+            {"input", std::make_shared<Input>()},
+            {"clock", std::make_shared<Clock>()}
+        };
+    }
+
 }
 
 
@@ -1,11 +1,22 @@
 #include <vector>
 #include <unordered_map>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <atomic>
 #include "Token.hpp"
 #include "Lexer.hpp"
 #include "Parser.hpp"
+#include "ParallelParser.hpp"
+#include "BodyLoader.hpp"
+#include "Resolver.hpp"
 #include "AstPrinter.hpp"
 #include "Typer.hpp"
+#include "Optimizer.hpp"
 #include "Interpreter.hpp"
+#include "Compiler.hpp"
+#include "VM.hpp"
+#include "ScriptCache.hpp"
 
 //TITLE: Zebra scripting language - 
 /*
@@ -16,10 +27,6 @@
 /*
  * HIGH PRIORITY
  */
-//All native functions (or all functions?) should have get_signature() to make type checking easier
-//  Could wrap all native functions into a map with name/Object - how about signature?
-//  in Typer, put all signatures into environment
-//
 //REPL needs to be possible for a scripting language
 //  make all native funtions load - get rid of (or disable) imports for now
 //  global variables can be overwritten - I don't like this idea.  Maybe have a keyword (like clear()) to clear environment variables
@@ -74,8 +81,10 @@
 //
 //Write tests for error codes - feed in source file and check what kinds of errors come out
 //
-//When mostly done with Crafting Interpreters, add a compiler between Typer and Interpreter to generate bytecode.  Make Interpreter read in bytecode instead of AST
-//  source code -> Lexer -> Parser -> Typer -> Compiler -> Interpreter
+//Pipeline is now: source code -> Lexer -> Parser -> Resolver -> Typer -> Optimizer -> Compiler -> VM
+//  bytecode is cached in <script>.zbc and reused while the source is unchanged
+//  every script goes through the frontend in parallel first, then they run one by one in order
+//  tree-walking Interpreter is kept behind --ast for comparing the two
 //
 /*
  * LOW PRIORITY
@@ -91,7 +100,6 @@
 //  How does Java do thi?
 //  source code -> Lexer -> Parser -> Inferer -> Typer -> Compiler -> Interpreter
 //
-//Don't like the confusing way 'returns' are dealt with in Interpreter / Environment / FunDef / Callables
 //
 //Block comments (easy)
 //
@@ -104,56 +112,187 @@
 //All Error types can inherit from same base class Error()
 //  printing errors in Main.cpp can just be done by using print() method (rather than calling cout << with all the fields)
 
-int main(int argc, char** argv) {
-    if (argc < 2) {
-        printf("Usage: zebra <script>");
-    } else {
+struct Options {
+    bool m_use_ast {false};
+    bool m_dump_opt {false}; //print every rewrite the Optimizer makes
+    bool m_inline {true}; //splice small functions into their callers
+};
 
-        for (int i = 1; i < argc; i++) {
+/*
+ * Everything the frontend produces for one script.  It is kept until the script has run, since
+ * tokens view the Lexer's source and the Interpreter walks the AST in the arena.
+ */
+struct Script {
+    const char* m_path;
+    zebra::Lexer m_lexer;
+    zebra::AstArena m_arena;
+    std::vector<zebra::Expr*> m_ast;
+    std::shared_ptr<zebra::Chunk> m_chunk;
+    std::ostringstream m_diagnostics; //printed when the script's turn to run comes, before it runs
+    bool m_ok {false};
+    bool m_use_ast {false}; //run by the Interpreter, asked for or because the script doesn't fit in bytecode
 
-            zebra::Lexer lexer(argv[i]); 
-            std::vector<zebra::Token> tokens;
-            zebra::ResultCode scan_result = lexer.scan(tokens); //this should return a result code
+    Script(const char* path): m_path(path) {}
+};
 
-            if (scan_result != zebra::ResultCode::SUCCESS) {
-                for (zebra::SyntaxError error: lexer.get_errors()) {
-                    error.print();
-                }
-                return 1;
-            }
+template <typename E>
+static bool report(std::vector<E> errors, std::ostream& out) {
+    for (E error: errors) {
+        error.print(out);
+    }
+    return errors.empty();
+}
+
+//reading through compiling (or only type checking for --ast); touches nothing shared but the symbol table
+static void run_frontend(Script& script, const Options& options) {
+    std::vector<zebra::SourceError> source_errors;
+    if (script.m_lexer.read_file(script.m_path, source_errors) != zebra::ResultCode::SUCCESS) {
+        report(source_errors, script.m_diagnostics);
+        return;
+    }
 
-//            zebra::Lexer::print_tokens(tokens);
+    //unchanged scripts skip straight to the VM with the bytecode saved by an earlier run
+    //the cache only holds bytecode built with inlining on
+    zebra::ScriptCache cache(script.m_path);
+    if (!options.m_use_ast && !options.m_dump_opt && options.m_inline) {
+        script.m_chunk = cache.load(script.m_lexer.source());
+        if (script.m_chunk) {
+            script.m_ok = true;
+            return;
+        }
+    }
 
-            zebra::Parser parser(tokens);
-            std::vector<std::shared_ptr<zebra::Expr>> ast;
-            zebra::ResultCode parse_result = parser.parse(ast);
+    //the parser pulls tokens from the lexer, so scanning happens during parsing
+    //large scripts are split and parsed on several threads
+    zebra::ParallelParser parser(script.m_lexer, script.m_arena);
+    zebra::ResultCode parse_result = parser.parse(script.m_ast);
 
-            if (parse_result != zebra::ResultCode::SUCCESS) {
-                for (zebra::ParseError error: parser.get_errors()) {
-                    error.print();
-                }
+    //syntax errors come first since they are likely the cause of any parse errors
+    if (!report(script.m_lexer.get_errors(), script.m_diagnostics)) return;
+    if (parse_result != zebra::ResultCode::SUCCESS) {
+        report(parser.get_errors(), script.m_diagnostics);
+        return;
+    }
+
+    //only functions named somewhere in the script get their bodies parsed
+    zebra::BodyLoader loader(script.m_lexer, script.m_arena);
+    if (loader.load(script.m_ast) != zebra::ResultCode::SUCCESS) {
+        report(loader.get_errors(), script.m_diagnostics);
+        return;
+    }
+
+    zebra::Resolver resolver;
+    if (resolver.resolve(script.m_ast) != zebra::ResultCode::SUCCESS) {
+        report(resolver.get_errors(), script.m_diagnostics);
+        return;
+    }
+
+//    zebra::AstPrinter printer;        
+//    printer.print(script.m_ast);
+
+    zebra::Typer typer;
+    if (typer.type(script.m_ast) != zebra::ResultCode::SUCCESS) {
+        report(typer.get_errors(), script.m_diagnostics);
+        return;
+    }
+
+    //both backends run the optimized tree
+    zebra::Optimizer optimizer(script.m_arena, resolver.global_slot_count(), options.m_inline);
+    optimizer.optimize(script.m_ast);
+    if (options.m_dump_opt) {
+        report(optimizer.get_notes(), script.m_diagnostics);
+    }
+
+    if (options.m_use_ast) {
+        script.m_use_ast = true;
+        script.m_ok = true;
+        return;
+    }
+
+    //bytecode operands are 16 bits, so scripts too large for them run on the Interpreter instead
+    zebra::Compiler compiler;
+    if (compiler.compile(script.m_ast, script.m_chunk) != zebra::ResultCode::SUCCESS) {
+        if (compiler.over_limit()) {
+            script.m_chunk = nullptr;
+            script.m_use_ast = true;
+            script.m_ok = true;
+            return;
+        }
+        report(compiler.get_errors(), script.m_diagnostics);
+        return;
+    }
+
+    //a cache that can't be written only means the next run compiles again
+    if (options.m_inline) cache.store(script.m_lexer.source(), *script.m_chunk);
+    script.m_ok = true;
+}
+
+//workers take the next script in line until none are left
+static void run_frontends(std::vector<std::unique_ptr<Script>>& scripts, const Options& options) {
+    std::atomic<size_t> next {0};
+    auto work = [&]() {
+        for (size_t i = next++; i < scripts.size(); i = next++) {
+            run_frontend(*scripts.at(i), options);
+        }
+    };
+
+    size_t thread_count = std::min<size_t>(scripts.size(), std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < thread_count; i++) {
+        workers.emplace_back(work);
+    }
+    work();
+    for (std::thread& worker: workers) {
+        worker.join();
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    std::vector<std::unique_ptr<Script>> scripts;
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "--ast") {
+            options.m_use_ast = true;
+        } else if (std::string(argv[i]) == "--dump-opt") {
+            options.m_dump_opt = true;
+        } else if (std::string(argv[i]) == "--no-inline") {
+            options.m_inline = false;
+        } else {
+            scripts.push_back(std::make_unique<Script>(argv[i]));
+        }
+    }
+
+    if (scripts.empty()) {
+        printf("Usage: zebra [--ast] [--dump-opt] [--no-inline] <script>");
+    } else {
+
+        run_frontends(scripts, options);
+
+        //diagnostics and execution follow the order the scripts were given in
+        for (std::unique_ptr<Script>& script: scripts) {
+            std::cout << script->m_diagnostics.str();
+            if (!script->m_ok) {
                 return 1;
             }
 
-//            zebra::AstPrinter printer;        
-//            printer.print(ast);
-/*
-            zebra::Typer typer;
-            zebra::ResultCode type_result = typer.type(ast);
+            if (script->m_use_ast) {
+                zebra::Interpreter interp;
+                zebra::ResultCode run_result = interp.run(script->m_ast);
 
-            if (type_result != zebra::ResultCode::SUCCESS) {
-                std::vector<zebra::TypeError> errors = typer.get_errors();
-                for (zebra::TypeError error: errors) {
-                    error.print();
+                if (run_result != zebra::ResultCode::SUCCESS) {
+                    for (zebra::RuntimeError error: interp.get_errors()) {
+                        error.print();
+                    }
+                    return 1;
                 }
-                return 1;
-            }*/
+                continue;
+            }
 
-            zebra::Interpreter interp;
-            zebra::ResultCode run_result = interp.run(ast);
+            zebra::VM vm;
+            zebra::ResultCode run_result = vm.run(script->m_chunk);
 
             if (run_result != zebra::ResultCode::SUCCESS) {
-                for (zebra::RuntimeError error: interp.get_errors()) {
+                for (zebra::RuntimeError error: vm.get_errors()) {
                     error.print();
                 }
                 return 1;
@@ -5,95 +5,109 @@ namespace zebra {
     Object::Object() {}
     Object::~Object() {}
 
-    Bool::Bool(bool value): m_value(value) {}
-    Bool::Bool(const Bool& obj): m_value(obj.m_value) {}
-    std::shared_ptr<Object> Bool::clone() {
-        return std::make_shared<Bool>(*this);
-    }
-
-    Int::Int(int value): m_value(value) {}
-    Int::Int(const Int& obj): m_value(obj.m_value) {}
-    std::shared_ptr<Object> Int::clone() {
-        return std::make_shared<Int>(*this);
-    }
+    String::String(std::string value): m_value(value) {}
 
-    Float::Float(float value): m_value(value) {}
-    Float::Float(const Float& obj): m_value(obj.m_value) {}
-    std::shared_ptr<Object> Float::clone() {
-        return std::make_shared<Float>(*this);
-    }
+    FunDef::FunDef(ExprList parameters, Expr* body, int slot_count)
+        : Callable(), m_parameters(parameters), m_body(body), m_slot_count(slot_count) {}
 
-    String::String(std::string value): m_value(value) {}
-    String::String(const String& obj): m_value(obj.m_value) {}
-    std::shared_ptr<Object> String::clone() {
-        return std::make_shared<String>(*this);
-    }
+    FunDef::FunDef(ExprList parameters, Expr* body, int slot_count, std::shared_ptr<Chunk> chunk)
+        : Callable(), m_parameters(parameters), m_body(body), m_slot_count(slot_count), m_chunk(chunk) {}
 
-    Nil::Nil() {}
-    Nil::Nil(const Nil& obj) {}
-    std::shared_ptr<Object> Nil::clone() {
-        return std::make_shared<Nil>(*this);
-    }
+    Value FunDef::call(const std::vector<Value>& arguments, Interpreter* interp) {
 
-    FunDef::FunDef(std::vector<std::shared_ptr<Expr>> parameters, std::shared_ptr<Expr> body)
-        : Callable(), m_parameters(parameters), m_body(body) {}
+        //parameters occupy the first slots of the function frame
+        for (int i = 0; i < int(m_parameters.size()); i++) {
+            interp->m_environment->define(i, arguments.at(i));
+        }
 
-    FunDef::FunDef(const FunDef& obj): Callable(), m_parameters(obj.m_parameters), m_body(obj.m_body) {}
+        //body shares the function frame rather than opening its own block scope
+        //Return stores its value in the interpreter and unwinds back to here
+        for (Expr* e: expr_cast<Block>(m_body)->m_expressions) {
+            if (interp->execute(e) == Completion::RETURN) {
+                return std::move(interp->m_return_value);
+            }
+        }
 
-    std::shared_ptr<Object> FunDef::clone() {
-        return std::make_shared<FunDef>(*this);
+        return Value();
     }
 
-    std::shared_ptr<Object> FunDef::call(std::vector<std::shared_ptr<Object>> arguments, Interpreter* interp) {
 
-        for (int i = 0; i < m_parameters.size(); i++) {
-            Token param_token = dynamic_cast<DeclVar*>(m_parameters.at(i).get())->m_name;
-            std::shared_ptr<Object> param_value = arguments.at(i);
-            interp->m_environment->define(param_token, param_value);
-        }
+    ClassDef::ClassDef(std::shared_ptr<ClassDef> base, const std::vector<std::pair<Token, Value>>& fields, 
+                       const std::vector<std::pair<Token, Value>>& methods, std::shared_ptr<Environment> global_env): m_base(base) {
+        static int next_id = 0;
+        m_id = next_id++;
 
-        //Return node sets return value to calling function env.
-        //which we grab using get_return() below
-        interp->evaluate(m_body.get());
+        std::vector<Value> method_values;
+        if (base) {
+            m_field_defaults = base->m_field_defaults;
+            m_field_slots = base->m_field_slots;
+            m_method_slots = base->m_method_slots;
+            for (int i = 0; i < int(base->m_method_slots.size()); i++) {
+                method_values.push_back(base->m_methods->get(i));
+            }
+        }
 
-        return interp->m_environment->get_return();
-    }
+        for (const std::pair<Token, Value>& p: fields) {
+            auto it = m_field_slots.find(p.first.m_symbol);
+            if (it != m_field_slots.end()) {
+                m_field_defaults.at(it->second) = p.second;
+            } else {
+                m_field_slots[p.first.m_symbol] = int(m_field_defaults.size());
+                m_field_defaults.push_back(p.second);
+            }
+        }
 
+        for (const std::pair<Token, Value>& p: methods) {
+            auto it = m_method_slots.find(p.first.m_symbol);
+            if (it != m_method_slots.end()) {
+                method_values.at(it->second) = p.second;
+            } else {
+                m_method_slots[p.first.m_symbol] = int(method_values.size());
+                method_values.push_back(p.second);
+            }
+        }
 
-    ClassDef::ClassDef(std::shared_ptr<Object> base,
-                       std::vector<std::pair<Token, std::shared_ptr<Object>>> fields, 
-                       std::vector<std::pair<Token, std::shared_ptr<Object>>> methods):
-                            m_base(base), m_fields(fields), m_methods(methods) {}
-    ClassDef::ClassDef(const ClassDef& obj) {
-        //TODO: this should never happen, right?
+        m_methods = std::make_shared<Environment>(global_env, false, int(method_values.size()));
+        for (int i = 0; i < int(method_values.size()); i++) {
+            m_methods->define(i, method_values.at(i));
+        }
     }
-    std::shared_ptr<Object> ClassDef::clone() {
-        return std::make_shared<ClassDef>(*this);
+    Value ClassDef::call(const std::vector<Value>&, Interpreter*) {
+        return instantiate();
     }
-    std::shared_ptr<Object> ClassDef::call(std::vector<std::shared_ptr<Object>> arguments, Interpreter* interp) {
-            if (m_base) {
-                std::shared_ptr<ClassDef> base = std::dynamic_pointer_cast<ClassDef>(m_base);
-                std::shared_ptr<ClassInst> base_instance = std::make_shared<ClassInst>(interp->m_global, base);
-                return std::make_shared<ClassInst>(base_instance->m_environment, shared_from_this());
-            } else {
-                return std::make_shared<ClassInst>(interp->m_global, shared_from_this());
-            }
+    Value ClassDef::instantiate() {
+        return Value(std::make_shared<ClassInst>(shared_from_this()));
     }
-            
-    ClassInst::ClassInst(std::shared_ptr<Environment> global_env, std::shared_ptr<ClassDef> def): m_class(def) {
-        m_environment = std::make_shared<Environment>(global_env, false);
-        for (std::pair<Token, std::shared_ptr<Object>> p: def->m_fields) {
-            m_environment->define(p.first, p.second);
-        }
-        for (std::pair<Token, std::shared_ptr<Object>> p: def->m_methods) {
-            m_environment->define(p.first, p.second);
+    int ClassDef::field_slot(int name) const {
+        auto it = m_field_slots.find(name);
+        return it != m_field_slots.end() ? it->second : -1;
+    }
+    int ClassDef::method_slot(int name) const {
+        auto it = m_method_slots.find(name);
+        return it != m_method_slots.end() ? it->second : -1;
+    }
+    int ClassDef::field_slot(int name, InlineCache& cache) const {
+        int slot = cache.lookup(m_id);
+        if (slot == -1) {
+            slot = field_slot(name);
+            cache.insert(m_id, slot);
         }
+        return slot;
     }
-    ClassInst::ClassInst(const ClassInst& obj) {
-        //TODO: this should never happen, right?  Otherwise we need to clone the environment
+    int ClassDef::method_slot(int name, InlineCache& cache) const {
+        int slot = cache.lookup(m_id);
+        if (slot == -1) {
+            slot = method_slot(name);
+            cache.insert(m_id, slot);
+        }
+        return slot;
     }
-    std::shared_ptr<Object> ClassInst::clone() {
-        return std::make_shared<ClassInst>(*this);
+            
+    ClassInst::ClassInst(std::shared_ptr<ClassDef> def): m_class(def) {
+        m_fields = std::make_shared<Environment>(def->m_methods, false, int(def->m_field_defaults.size()));
+        for (int i = 0; i < int(def->m_field_defaults.size()); i++) {
+            m_fields->define(i, def->m_field_defaults.at(i));
+        }
     }
 
 }
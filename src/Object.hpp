@@ -8,41 +8,19 @@
 #include "Token.hpp"
 #include "Interpreter.hpp"
 #include "DataType.hpp"
+#include "Chunk.hpp"
+#include "Value.hpp"
+#include "InlineCache.hpp"
 
 namespace zebra {
 
+    /*
+     * Heap objects referenced by Value.  Scalars (bool, int, float, nil) are stored inline in Value.
+     */
     class Object {
         public:
             Object();
             virtual ~Object();
-            virtual std::shared_ptr<Object> clone() = 0;
-    };
-
-    class Bool: public Object {
-        public:
-            bool m_value;
-        public:
-            Bool(bool value);
-            Bool(const Bool& obj);
-            virtual std::shared_ptr<Object> clone() override;
-    };
-
-    class Int: public Object {
-        public:
-            int m_value;
-        public:
-            Int(int value);
-            Int(const Int& obj);
-            virtual std::shared_ptr<Object> clone() override;
-    };
-
-    class Float: public Object {
-        public:
-            float m_value;
-        public:
-            Float(float value);
-            Float(const Float& obj);
-            virtual std::shared_ptr<Object> clone() override;
     };
 
     class String: public Object {
@@ -50,16 +28,6 @@ namespace zebra {
             std::string m_value;
         public:
             String(std::string value);
-            String(const String& obj);
-            virtual std::shared_ptr<Object> clone() override;
-    };
-
-    class Nil: public Object {
-        public:
-        public:
-            Nil();
-            Nil(const Nil& obj);
-            virtual std::shared_ptr<Object> clone() override;
     };
 
     class Callable: public Object {
@@ -68,42 +36,57 @@ namespace zebra {
         public:
             Callable(std::vector<DataType> signature): m_signature(signature) {}
             Callable() {}
-            virtual std::shared_ptr<Object> call(std::vector<std::shared_ptr<Object>> arguments, Interpreter* interp) = 0;
+            virtual Value call(const std::vector<Value>& arguments, Interpreter* interp) = 0;
     };
     
     class FunDef: public Callable {
         public:
-            std::vector<std::shared_ptr<Expr>> m_parameters;
-            std::shared_ptr<Expr> m_body;
+            ExprList m_parameters;
+            Expr* m_body;
+            int m_slot_count;
+            std::shared_ptr<Chunk> m_chunk {nullptr}; //set when compiled for the VM
         public:
-            FunDef(std::vector<std::shared_ptr<Expr>> parameters, std::shared_ptr<Expr> body);
-            FunDef(const FunDef& obj);
-            virtual std::shared_ptr<Object> clone() override;
-            virtual std::shared_ptr<Object> call(std::vector<std::shared_ptr<Object>> arguments, Interpreter* interp) override;
+            FunDef(ExprList parameters, Expr* body, int slot_count);
+            FunDef(ExprList parameters, Expr* body, int slot_count, std::shared_ptr<Chunk> chunk);
+            virtual Value call(const std::vector<Value>& arguments, Interpreter* interp) override;
     };
 
+    /*
+     * Layout shared by every instance of a class.  Fields and methods are flattened over the
+     * inheritance chain: inherited members keep the base class slots, overrides reuse them and
+     * new members are appended, matching the slots the Resolver assigns.
+     */
     class ClassDef: public Callable, public std::enable_shared_from_this<ClassDef> {
         public:
-            std::shared_ptr<Object> m_base;
-            std::vector<std::pair<Token, std::shared_ptr<Object>>> m_fields;
-            std::vector<std::pair<Token, std::shared_ptr<Object>>> m_methods;
-        public:
-            ClassDef(std::shared_ptr<Object> base,
-                     std::vector<std::pair<Token, std::shared_ptr<Object>>> fields, 
-                     std::vector<std::pair<Token, std::shared_ptr<Object>>> methods);
-            ClassDef(const ClassDef& obj);
-            virtual std::shared_ptr<Object> clone() override;
-            virtual std::shared_ptr<Object> call(std::vector<std::shared_ptr<Object>> arguments, Interpreter* interp) override;
+            std::shared_ptr<ClassDef> m_base;
+            int m_id; //unique per declaration, keys inline caches
+            std::vector<Value> m_field_defaults;
+            std::unordered_map<int, int> m_field_slots;
+            std::shared_ptr<Environment> m_methods; //one frame per class, closing over the global frame
+            std::unordered_map<int, int> m_method_slots;
+        public:
+            ClassDef(std::shared_ptr<ClassDef> base, const std::vector<std::pair<Token, Value>>& fields, 
+                     const std::vector<std::pair<Token, Value>>& methods, std::shared_ptr<Environment> global_env);
+            virtual Value call(const std::vector<Value>& arguments, Interpreter* interp) override;
+            Value instantiate();
+            //slot of the field or method (own or inherited), or -1 if there is none
+            int field_slot(int name) const;
+            int method_slot(int name) const;
+            //same lookups, remembered per access site
+            int field_slot(int name, InlineCache& cache) const;
+            int method_slot(int name, InlineCache& cache) const;
     };
 
+    /*
+     * Instances only hold their field values.  The field frame closes over the class method
+     * frame, so method bodies called on the instance can reach both by (depth, slot).
+     */
     class ClassInst: public Object {
         public:
-            std::shared_ptr<Environment> m_environment;
             std::shared_ptr<ClassDef> m_class;
+            std::shared_ptr<Environment> m_fields;
         public:
-            ClassInst(std::shared_ptr<Environment> global_env, std::shared_ptr<ClassDef> def);
-            ClassInst(const ClassInst& obj);
-            virtual std::shared_ptr<Object> clone() override;
+            ClassInst(std::shared_ptr<ClassDef> def);
     };
 
 }
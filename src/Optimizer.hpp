@@ -0,0 +1,1247 @@
+#ifndef ZEBRA_OPTIMIZER_H
+#define ZEBRA_OPTIMIZER_H
+
+#include <vector>
+#include <unordered_map>
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <climits>
+#include <cstring>
+
+#include "Token.hpp"
+#include "Expr.hpp"
+#include "Object.hpp"
+#include "ResultCode.hpp"
+
+namespace zebra {
+
+    //a rewrite made by the Optimizer, printed with --dump-opt
+    struct OptimizeNote {
+        Token m_token;
+        std::string m_message;
+        OptimizeNote(Token token, const std::string& message): m_token(token), m_message(message) {}
+        void print(std::ostream& out = std::cout) {
+            out << "[Line " << m_token.m_line << "] Optimized: " << m_message << std::endl;
+        }
+    };
+
+
+    /*
+     * Scans the statements of one frame for pure expressions computed more than once.  Frames are
+     * numbered relative to the frame being scanned: 0 is the frame itself, nested blocks count up
+     * and enclosing frames count down, so (frame, slot) names the same variable from any depth.
+     *
+     * An expression is pure when the Typer gave every node a primitive type and its only leaves are
+     * literals and variables visible from frame 0.  Integer division is left out since hoisting it
+     * could raise a division by zero the original code guarded against.
+     *
+     * Calls may write any variable in the frames enclosing frame 0.  Frame 0 and the frames nested
+     * in it can only be written by functions declared among the scanned statements, since scoping is
+     * lexical, and by methods when frame 0 is the global frame.
+     *
+     * Writing a field through an instance counts as a write to every enclosing frame too.  Inside a
+     * method the instance may be the receiver, whose fields the method also reads as plain variables.
+     */
+    class CommonScan {
+        friend struct ExprDispatch;
+        public:
+            struct Occurrence {
+                std::string m_key;
+                Expr** m_site;
+                int m_level; //frame the site sits in
+                int m_statement;
+                bool m_in_loop; //runs on every iteration of a loop within the statement
+            };
+            struct Writes {
+                std::vector<std::pair<int, int>> m_slots;
+                bool m_calls {false};
+                bool m_fields {false}; //writes a field through an instance
+            };
+        public:
+            std::vector<Occurrence> m_occurrences;
+            std::vector<Writes> m_writes; //by statement
+        private:
+            bool m_declares_functions;
+            int m_level {0};
+            int m_statement {0};
+            int m_loops {0};
+        public:
+            //statements scanned on their own still need to know about functions declared next to them
+            CommonScan(bool declares_functions = false): m_declares_functions(declares_functions) {}
+            ~CommonScan() {}
+
+            void scan(std::vector<Expr*>& statements) {
+                for (Expr*& statement: statements) {
+                    add(statement);
+                }
+            }
+
+            //statements are numbered in the order they are added
+            void add(Expr*& statement) {
+                m_writes.emplace_back();
+                walk(statement);
+                m_statement++;
+            }
+
+            bool declares_functions() const {
+                return m_declares_functions;
+            }
+
+            //true if running the statement may change any of the variables
+            bool writes(int statement, const std::vector<std::pair<int, int>>& reads) const {
+                const Writes& writes = m_writes.at(statement);
+                for (const std::pair<int, int>& slot: reads) {
+                    if (writes.m_calls && (slot.first < 0 || m_declares_functions)) return true;
+                    if (writes.m_fields && slot.first < 0) return true;
+                    if (std::find(writes.m_slots.begin(), writes.m_slots.end(), slot) != writes.m_slots.end()) return true;
+                }
+                return false;
+            }
+
+            //variables read by a pure expression found at the given level
+            static void reads(Expr* expr, int level, std::vector<std::pair<int, int>>& out) {
+                if (GetVar* get = expr_cast<GetVar>(expr)) {
+                    out.emplace_back(level - get->m_depth, get->m_slot);
+                } else if (Unary* unary = expr_cast<Unary>(expr)) {
+                    reads(unary->m_right, level, out);
+                } else if (Group* group = expr_cast<Group>(expr)) {
+                    reads(group->m_expr, level, out);
+                } else if (Binary* binary = expr_cast<Binary>(expr)) {
+                    reads(binary->m_left, level, out);
+                    reads(binary->m_right, level, out);
+                } else if (Logic* logic = expr_cast<Logic>(expr)) {
+                    reads(logic->m_left, level, out);
+                    reads(logic->m_right, level, out);
+                }
+            }
+
+            //moves a pure expression found at the given level up to frame 0
+            static void rebase(Expr* expr, int level) {
+                if (GetVar* get = expr_cast<GetVar>(expr)) {
+                    get->m_depth -= level;
+                } else if (Unary* unary = expr_cast<Unary>(expr)) {
+                    rebase(unary->m_right, level);
+                } else if (Group* group = expr_cast<Group>(expr)) {
+                    rebase(group->m_expr, level);
+                } else if (Binary* binary = expr_cast<Binary>(expr)) {
+                    rebase(binary->m_left, level);
+                    rebase(binary->m_right, level);
+                } else if (Logic* logic = expr_cast<Logic>(expr)) {
+                    rebase(logic->m_left, level);
+                    rebase(logic->m_right, level);
+                }
+            }
+
+        private:
+            //key of a pure expression, or empty; only operators are worth sharing
+            std::string walk(Expr*& site) {
+                if (!site) return "";
+                std::string key = ExprDispatch::visit(*this, site);
+                if (!key.empty() && (site->m_kind == ExprKind::BINARY || site->m_kind == ExprKind::LOGIC)) {
+                    m_occurrences.push_back({key, &site, m_level, m_statement, m_loops > 0});
+                }
+                return key;
+            }
+
+            void walk(ExprList list) {
+                for (Expr*& e: list) {
+                    walk(e);
+                }
+            }
+
+            void write(int frame, int slot) {
+                m_writes.back().m_slots.emplace_back(frame, slot);
+            }
+
+            static bool primitive(Expr* expr) {
+                switch(expr->m_data_type.m_type) {
+                    case TokenType::INT_TYPE:
+                    case TokenType::FLOAT_TYPE:
+                    case TokenType::BOOL_TYPE:
+                    case TokenType::STRING_TYPE:
+                        return true;
+                    default:
+                        return false;
+                }
+            }
+
+            static std::string join(Expr* expr, const std::string& left, TokenType op, const std::string& right) {
+                if (left.empty() || right.empty() || !primitive(expr)) return "";
+                return "(" + left + " " + std::to_string(int(op)) + " " + right + ")";
+            }
+
+            /*
+             * Basic
+             */
+            std::string visit(Unary* expr) {
+                std::string right = walk(expr->m_right);
+                if (right.empty() || !primitive(expr)) return "";
+                return "(" + std::to_string(int(expr->m_op.m_type)) + " " + right + ")";
+            }
+            std::string visit(Binary* expr) {
+                std::string left = walk(expr->m_left);
+                std::string right = walk(expr->m_right);
+                bool int_division = expr->m_data_type.m_type == TokenType::INT_TYPE &&
+                                    (expr->m_op.m_type == TokenType::SLASH || expr->m_op.m_type == TokenType::MOD);
+                if (int_division) return "";
+                return join(expr, left, expr->m_op.m_type, right);
+            }
+            std::string visit(Group* expr) {
+                return walk(expr->m_expr);
+            }
+            std::string visit(Literal* expr) {
+                if (!primitive(expr)) return "";
+                std::ostringstream key;
+                switch(expr->m_value.m_type) {
+                    case ValueType::BOOL: key << "b" << expr->m_value.m_bool; break;
+                    case ValueType::INT: key << "i" << expr->m_value.m_int; break;
+                    case ValueType::FLOAT: key << "f" << std::setprecision(9) << expr->m_value.m_float; break;
+                    case ValueType::STRING: key << "s" << std::quoted(expr->m_value.as_string()); break;
+                    default: return "";
+                }
+                return key.str();
+            }
+            std::string visit(Logic* expr) {
+                std::string left = walk(expr->m_left);
+                std::string right = walk(expr->m_right);
+                return join(expr, left, expr->m_op.m_type, right);
+            }
+
+            /*
+             * Variables and Functions
+             */
+            std::string visit(DeclVar* expr) {
+                walk(expr->m_value);
+                write(m_level, expr->m_slot);
+                return "";
+            }
+            std::string visit(GetVar* expr) {
+                int frame = m_level - expr->m_depth;
+                if (expr->m_env.m_type != TokenType::NIL || frame > 0 || !primitive(expr)) return "";
+                return "v" + std::to_string(frame) + ":" + std::to_string(expr->m_slot);
+            }
+            std::string visit(SetVar* expr) {
+                walk(expr->m_value);
+                if (expr->m_env.m_type == TokenType::NIL) {
+                    write(m_level - expr->m_depth, expr->m_slot);
+                } else {
+                    m_writes.back().m_fields = true;
+                }
+                return "";
+            }
+            //the body only runs when called, and calls are already counted as writes
+            std::string visit(DeclFun* expr) {
+                write(m_level, expr->m_slot);
+                m_declares_functions = true;
+                return "";
+            }
+            std::string visit(CallFun* expr) {
+                walk(expr->m_arguments);
+                m_writes.back().m_calls = true;
+                return "";
+            }
+            std::string visit(Return* expr) {
+                walk(expr->m_value);
+                return "";
+            }
+
+            /*
+             * Control Flow
+             */
+            std::string visit(Block* expr) {
+                m_level++;
+                walk(expr->m_expressions);
+                m_level--;
+                return "";
+            }
+            std::string visit(If* expr) {
+                walk(expr->m_condition);
+                walk(expr->m_then_branch);
+                walk(expr->m_else_branch);
+                return "";
+            }
+            std::string visit(For* expr) {
+                walk(expr->m_initializer);
+                m_loops++;
+                walk(expr->m_condition);
+                walk(expr->m_update);
+                walk(expr->m_body);
+                m_loops--;
+                return "";
+            }
+            std::string visit(While* expr) {
+                m_loops++;
+                walk(expr->m_condition);
+                walk(expr->m_body);
+                m_loops--;
+                return "";
+            }
+
+            /*
+             * Classes
+             */
+            //field initializers run where the class is declared, methods only when called
+            std::string visit(DeclClass* expr) {
+                for (Expr* field: expr->m_fields) {
+                    walk(expr_cast<DeclVar>(field)->m_value);
+                }
+                write(m_level, expr->m_slot);
+                m_declares_functions = true; //methods see the global frame
+                return "";
+            }
+    };
+
+
+    /*
+     * Rewrites the typed AST before it reaches the Interpreter or the Compiler:
+     *  folding - unary, binary and logic operators over literals become a single literal
+     *  dead branches - if, while and for statements with a literal condition lose the code that can never run
+     *  common subexpressions - a pure expression computed more than once in a run of statements
+     *      that writes none of its variables is computed once into a new slot of the frame
+     *  loop invariants - a pure expression inside a loop that writes none of its variables is
+     *      computed once before the loop
+     *  strength reduction - i * k in a for loop stepping i by a constant, with k an integer literal,
+     *      becomes a variable stepped by k times as much alongside i
+     *  inlining - a call to a small function whose body is a single return becomes a copy of the
+     *      returned expression, with the arguments in place of the parameters
+     * Slots added here are counted into the frame sizes the Resolver worked out.
+     */
+    class Optimizer {
+        friend struct ExprDispatch;
+        private:
+            AstArena& m_arena;
+            int m_global_slot_count;
+            bool m_inline_calls;
+            std::vector<std::unordered_map<int, DeclFun*>> m_frames; //functions calls can be inlined from, by slot
+            std::vector<OptimizeNote> m_notes;
+        public:
+            Optimizer(AstArena& arena, int global_slot_count, bool inline_calls = true): 
+                m_arena(arena), m_global_slot_count(global_slot_count), m_inline_calls(inline_calls) {}
+            ~Optimizer() {}
+
+            ResultCode optimize(std::vector<Expr*>& ast) {
+                ast = statements(ast, m_global_slot_count);
+
+                //nested blocks are finished before the statements around them
+                std::stable_sort(m_notes.begin(), m_notes.end(), [](const OptimizeNote& a, const OptimizeNote& b) {
+                    return a.m_token.m_line < b.m_token.m_line;
+                });
+                return ResultCode::SUCCESS;
+            }
+
+            std::vector<OptimizeNote> get_notes() const {
+                return m_notes;
+            }
+
+        private:
+            //null for statements that were removed
+            Expr* optimize(Expr* expr) {
+                return expr ? ExprDispatch::visit(*this, expr) : nullptr;
+            }
+
+            //where a node has to stay, a removed statement leaves an empty block, which is also nil as a value
+            Expr* required(Expr* expr, const Token& name) {
+                Expr* result = optimize(expr);
+                return result ? result : m_arena.make<Block>(name, ExprList());
+            }
+
+            void note(const Token& token, const std::string& message) {
+                m_notes.emplace_back(token, message);
+            }
+
+            std::vector<Expr*> statements(const std::vector<Expr*>& list, int& slot_count) {
+                //a slot declared twice may hold another function by the time a call runs
+                std::unordered_map<int, int> declarations;
+                for (Expr* e: list) {
+                    count_declarations(e, declarations);
+                }
+
+                //functions are only inlined into calls following their declaration, as the Resolver sees them
+                m_frames.emplace_back();
+                std::vector<Expr*> result;
+                for (Expr* e: list) {
+                    Expr* optimized = optimize(e);
+                    if (optimized) result.push_back(optimized);
+
+                    DeclFun* fun = expr_cast<DeclFun>(optimized);
+                    if (fun && declarations[fun->m_slot] == 1) m_frames.back()[fun->m_slot] = fun;
+                }
+                m_frames.pop_back();
+
+                //loop bodies are already done, so invariants move out one loop at a time
+                CommonScan frame;
+                frame.scan(result);
+                for (int i = 0; i < int(result.size()); i++) {
+                    if (result.at(i)->m_kind == ExprKind::FOR || result.at(i)->m_kind == ExprKind::WHILE) {
+                        i += optimize_loop(result, i, slot_count, frame.declares_functions());
+                    }
+                }
+
+                while (share_common(result, slot_count)) {}
+                return result;
+            }
+
+            ExprList statements(ExprList list, int& slot_count) {
+                return m_arena.list(statements(std::vector<Expr*>(list.begin(), list.end()), slot_count));
+            }
+
+            /*
+             * Common subexpressions
+             */
+
+            //shares the largest expression repeated within a run of statements; false once there is none
+            bool share_common(std::vector<Expr*>& list, int& slot_count) {
+                CommonScan scan;
+                scan.scan(list);
+
+                std::unordered_map<std::string, std::vector<const CommonScan::Occurrence*>> by_key;
+                std::vector<std::string> keys; //first seen order, so the choice doesn't depend on hashing
+                for (const CommonScan::Occurrence& occurrence: scan.m_occurrences) {
+                    std::vector<const CommonScan::Occurrence*>& group = by_key[occurrence.m_key];
+                    if (group.empty()) keys.push_back(occurrence.m_key);
+                    group.push_back(&occurrence);
+                }
+
+                std::vector<const CommonScan::Occurrence*> best;
+                for (const std::string& key: keys) {
+                    std::vector<const CommonScan::Occurrence*> run = first_run(by_key[key], scan);
+                    if (run.size() >= 2 && (best.empty() || key.size() > best.front()->m_key.size())) {
+                        best = run;
+                    }
+                }
+                if (best.empty()) return false;
+
+                note(op_token(best.front()), "computed '" + describe(*best.front()->m_site) + "' once for its " +
+                                             std::to_string(best.size()) + " uses.");
+                share(list, best.front()->m_statement, slot_count, best);
+                return true;
+            }
+
+            /*
+             * Declares a new variable in front of list[position] holding the expression at the first use,
+             * and makes every use read it instead.  Returns the variable's slot.
+             */
+            int share(std::vector<Expr*>& list, int position, int& slot_count, const std::vector<const CommonScan::Occurrence*>& uses) {
+                const CommonScan::Occurrence* first = uses.front();
+                Expr* value = *first->m_site;
+                CommonScan::rebase(value, first->m_level);
+
+                Token name = temp_name(op_token(first));
+                Token type(value->m_data_type.m_type, nullptr, 0, name.m_line);
+                int slot = slot_count++;
+
+                for (const CommonScan::Occurrence* occurrence: uses) {
+                    *occurrence->m_site = temp(name, occurrence->m_level, slot, value->m_data_type);
+                }
+
+                DeclVar* decl = m_arena.make<DeclVar>(name, type, value);
+                decl->m_slot = slot;
+                decl->m_data_type = value->m_data_type;
+                list.insert(list.begin() + position, decl);
+                return slot;
+            }
+
+            GetVar* temp(const Token& name, int depth, int slot, DataType type) {
+                GetVar* get = m_arena.make<GetVar>(name, Token());
+                get->m_depth = depth;
+                get->m_slot = slot;
+                get->m_data_type = type;
+                return get;
+            }
+
+            static Token temp_name(const Token& at) {
+                return Token(TokenType::IDENTIFIER, TEMP_NAME, uint32_t(std::strlen(TEMP_NAME)), at.m_line);
+            }
+
+            //occurrences up to the first statement writing a variable the expression reads
+            static std::vector<const CommonScan::Occurrence*> first_run(const std::vector<const CommonScan::Occurrence*>& group,
+                                                                        const CommonScan& scan) {
+                std::vector<std::pair<int, int>> reads;
+                CommonScan::reads(*group.front()->m_site, group.front()->m_level, reads);
+
+                std::vector<const CommonScan::Occurrence*> run;
+                int statement = group.front()->m_statement;
+                for (const CommonScan::Occurrence* occurrence: group) {
+                    for (; statement <= occurrence->m_statement; statement++) {
+                        if (scan.writes(statement, reads)) {
+                            if (run.size() >= 2) return run;
+                            run.clear();
+                        }
+                    }
+                    //the statement the run breaks at is left out entirely
+                    if (scan.writes(occurrence->m_statement, reads)) continue;
+                    run.push_back(occurrence);
+                }
+                return run;
+            }
+
+            //occurrences are always operators
+            static const Token& op_token(const CommonScan::Occurrence* occurrence) {
+                Expr* value = *occurrence->m_site;
+                if (Binary* binary = expr_cast<Binary>(value)) return binary->m_op;
+                return static_cast<Logic*>(value)->m_op;
+            }
+
+            static constexpr const char* TEMP_NAME = "(temp)";
+
+            /*
+             * Loops
+             */
+
+            //rewrites the loop at list[index] and returns how many statements were put in front of it
+            int optimize_loop(std::vector<Expr*>& list, int index, int& slot_count, bool declares_functions) {
+                int start = index;
+                while (hoist_invariant(list, index, slot_count, declares_functions)) {
+                    index++;
+                }
+                int inserted;
+                while ((inserted = reduce_strength(list, index, slot_count, declares_functions)) > 0) {
+                    index += inserted;
+                }
+                return index - start;
+            }
+
+            //moves the largest invariant expression of the loop in front of it; false once there is none
+            bool hoist_invariant(std::vector<Expr*>& list, int index, int& slot_count, bool declares_functions) {
+                CommonScan scan(declares_functions);
+                scan.add(list.at(index));
+
+                const CommonScan::Occurrence* best = nullptr;
+                for (const CommonScan::Occurrence& occurrence: scan.m_occurrences) {
+                    if (!occurrence.m_in_loop) continue;
+                    if (best && occurrence.m_key.size() <= best->m_key.size()) continue;
+
+                    std::vector<std::pair<int, int>> reads;
+                    CommonScan::reads(*occurrence.m_site, occurrence.m_level, reads);
+                    if (!scan.writes(0, reads)) best = &occurrence;
+                }
+                if (!best) return false;
+
+                std::vector<const CommonScan::Occurrence*> uses;
+                for (const CommonScan::Occurrence& occurrence: scan.m_occurrences) {
+                    if (occurrence.m_key == best->m_key) uses.push_back(&occurrence);
+                }
+
+                note(op_token(best), "moved '" + describe(*best->m_site) + "' out of the loop.");
+                share(list, index, slot_count, uses);
+                return true;
+            }
+
+            /*
+             * Replaces one i * k in a for loop with a variable that starts at i * k once the initializer
+             * has run and is stepped at the end of the body.  The initializer is moved in front of the
+             * loop for that, which changes nothing since it already runs in the enclosing frame.
+             * Returns how many statements were put in front of the loop, 0 if nothing was reduced.
+             */
+            int reduce_strength(std::vector<Expr*>& list, int index, int& slot_count, bool declares_functions) {
+                For* loop = expr_cast<For>(list.at(index));
+                if (!loop || !loop->m_condition) return 0;
+                Block* body = expr_cast<Block>(loop->m_body);
+                SetVar* update = expr_cast<SetVar>(loop->m_update);
+                int step;
+                if (!body || !update || !induction_step(update, step)) return 0;
+
+                //only the update may change the induction variable
+                CommonScan scan(declares_functions);
+                scan.add(loop->m_condition);
+                scan.add(loop->m_body);
+                std::vector<std::pair<int, int>> induction {{0, update->m_slot}};
+                if (scan.writes(0, induction) || scan.writes(1, induction)) return 0;
+
+                std::vector<const CommonScan::Occurrence*> uses;
+                int factor = 0;
+                for (const CommonScan::Occurrence& occurrence: scan.m_occurrences) {
+                    int k;
+                    if (!product(*occurrence.m_site, occurrence.m_level, update->m_slot, k)) continue;
+                    if (uses.empty() || occurrence.m_key == uses.front()->m_key) {
+                        uses.push_back(&occurrence);
+                        factor = k;
+                    }
+                }
+                if (uses.empty()) return 0;
+
+                int inserted = 0;
+                if (loop->m_initializer) {
+                    list.insert(list.begin() + index, loop->m_initializer);
+                    loop->m_initializer = nullptr;
+                    index++;
+                    inserted++;
+                }
+
+                const Token& op = op_token(uses.front());
+                int delta = int(unsigned(step) * unsigned(factor));
+                note(op, "replaced '" + describe(*uses.front()->m_site) + "' with a variable stepped by " +
+                         std::to_string(delta) + " each iteration.");
+
+                int slot = share(list, index, slot_count, uses);
+                inserted++;
+
+                Token name = temp_name(op);
+                DataType int_type(TokenType::INT_TYPE);
+                Binary* next = m_arena.make<Binary>(Token(TokenType::PLUS, nullptr, 0, name.m_line),
+                                                    temp(name, 1, slot, int_type),
+                                                    make_literal(name, Value(delta), int_type));
+                next->m_data_type = int_type;
+                SetVar* advance = m_arena.make<SetVar>(name, Token(), next);
+                advance->m_depth = 1;
+                advance->m_slot = slot;
+                advance->m_data_type = int_type;
+
+                std::vector<Expr*> expressions(body->m_expressions.begin(), body->m_expressions.end());
+                expressions.push_back(advance);
+                body->m_expressions = m_arena.list(expressions);
+                return inserted;
+            }
+
+            //the update is i = i + c, i = c + i or i = i - c for an integer literal c
+            static bool induction_step(SetVar* update, int& step) {
+                if (update->m_env.m_type != TokenType::NIL || update->m_depth != 0) return false;
+
+                Binary* value = expr_cast<Binary>(strip(update->m_value));
+                if (!value || value->m_data_type.m_type != TokenType::INT_TYPE) return false;
+
+                bool plus = value->m_op.m_type == TokenType::PLUS;
+                if (!plus && value->m_op.m_type != TokenType::MINUS) return false;
+
+                int c;
+                if (is_var(value->m_left, 0, update->m_slot) && int_literal(value->m_right, c)) {
+                    step = plus ? c : int(0u - unsigned(c));
+                    return true;
+                }
+                if (plus && int_literal(value->m_left, c) && is_var(value->m_right, 0, update->m_slot)) {
+                    step = c;
+                    return true;
+                }
+                return false;
+            }
+
+            //i * k or k * i, for the variable in slot i of frame 0 seen from the given level
+            static bool product(Expr* expr, int level, int slot, int& k) {
+                Binary* binary = expr_cast<Binary>(expr);
+                if (!binary || binary->m_op.m_type != TokenType::STAR || binary->m_data_type.m_type != TokenType::INT_TYPE) {
+                    return false;
+                }
+                return (is_var(binary->m_left, level, slot) && int_literal(binary->m_right, k)) ||
+                       (int_literal(binary->m_left, k) && is_var(binary->m_right, level, slot));
+            }
+
+            static bool is_var(Expr* expr, int depth, int slot) {
+                GetVar* get = expr_cast<GetVar>(strip(expr));
+                return get && get->m_env.m_type == TokenType::NIL && get->m_depth == depth && get->m_slot == slot;
+            }
+
+            static bool int_literal(Expr* expr, int& value) {
+                Literal* literal = expr_cast<Literal>(strip(expr));
+                if (!literal || !literal->m_value.is_int()) return false;
+                value = literal->m_value.m_int;
+                return true;
+            }
+
+            static Expr* strip(Expr* expr) {
+                while (Group* group = expr_cast<Group>(expr)) {
+                    expr = group->m_expr;
+                }
+                return expr;
+            }
+
+            /*
+             * Inlining
+             */
+            static const int INLINE_LIMIT = 16; //nodes in the returned expression
+
+            //declarations a statement makes in the frame it runs in
+            static void count_declarations(Expr* expr, std::unordered_map<int, int>& counts) {
+                if (DeclVar* decl_var = expr_cast<DeclVar>(expr)) {
+                    counts[decl_var->m_slot]++;
+                } else if (DeclFun* decl_fun = expr_cast<DeclFun>(expr)) {
+                    counts[decl_fun->m_slot]++;
+                } else if (DeclClass* decl_class = expr_cast<DeclClass>(expr)) {
+                    counts[decl_class->m_slot]++;
+                } else if (If* branch = expr_cast<If>(expr)) {
+                    count_declarations(branch->m_then_branch, counts);
+                    count_declarations(branch->m_else_branch, counts);
+                } else if (For* loop = expr_cast<For>(expr)) {
+                    count_declarations(loop->m_initializer, counts);
+                    count_declarations(loop->m_body, counts);
+                } else if (While* loop = expr_cast<While>(expr)) {
+                    count_declarations(loop->m_body, counts);
+                }
+            }
+
+            /*
+             * The callee's returned expression copied into the caller, or null if the call has to stay.
+             * Arguments are substituted rather than evaluated up front, so each one has to give the same
+             * value wherever and however often the copy reads it:
+             *  a body making calls may change any variable, so only literal arguments are allowed
+             *  otherwise literals and variables can be read any number of times
+             *  and other pure expressions, which can't raise errors, can be read at most once
+             */
+            Expr* inline_call(CallFun* call) {
+                if (!m_inline_calls || call->m_env.m_type != TokenType::NIL) return nullptr;
+
+                int frame = int(m_frames.size()) - 1 - call->m_depth;
+                if (frame < 0) return nullptr;
+                auto it = m_frames.at(frame).find(call->m_slot);
+                if (it == m_frames.at(frame).end()) return nullptr;
+
+                DeclFun* fun = it->second;
+                Expr* value = inline_body(fun);
+                if (!value) return nullptr;
+
+                std::vector<int> uses(fun->m_parameters.size(), 0);
+                bool calls = false;
+                count_uses(value, uses, calls);
+                for (int i = 0; i < call->m_arguments.size(); i++) {
+                    Expr* argument = call->m_arguments.at(i);
+                    bool cheap = argument->m_kind == ExprKind::LITERAL ||
+                                 (argument->m_kind == ExprKind::GET_VAR && static_cast<GetVar*>(argument)->m_env.m_type == TokenType::NIL);
+                    if (calls ? argument->m_kind != ExprKind::LITERAL : !(cheap || (pure(argument) && uses.at(i) <= 1))) {
+                        return nullptr;
+                    }
+                }
+
+                note(call->m_name, "inlined '" + describe(call) + "'.");
+                std::vector<Expr*> arguments(call->m_arguments.begin(), call->m_arguments.end());
+                //the body sits one frame in from where the function was declared
+                return clone(value, call->m_depth - 1, &arguments);
+            }
+
+            //the expression returned by a body made of a single return, if it is small enough to copy
+            static Expr* inline_body(DeclFun* fun) {
+                switch(fun->m_return_type.m_type) {
+                    case TokenType::INT_TYPE:
+                    case TokenType::FLOAT_TYPE:
+                    case TokenType::BOOL_TYPE:
+                    case TokenType::STRING_TYPE:
+                        break;
+                    default:
+                        return nullptr;
+                }
+
+                Block* body = expr_cast<Block>(fun->m_body);
+                if (!body || body->m_expressions.size() != 1) return nullptr;
+                Return* ret = expr_cast<Return>(body->m_expressions.at(0));
+                if (!ret || !ret->m_value) return nullptr;
+
+                int size = 0;
+                if (!copyable(ret->m_value, fun, size) || size > INLINE_LIMIT) return nullptr;
+                return ret->m_value;
+            }
+
+            //false for nodes clone() can't copy, recursive calls and parameters used as instances
+            static bool copyable(Expr* expr, DeclFun* fun, int& size) {
+                size++;
+                switch(expr->m_kind) {
+                    case ExprKind::UNARY:
+                        return copyable(static_cast<Unary*>(expr)->m_right, fun, size);
+                    case ExprKind::BINARY: {
+                        Binary* binary = static_cast<Binary*>(expr);
+                        return copyable(binary->m_left, fun, size) && copyable(binary->m_right, fun, size);
+                    }
+                    case ExprKind::GROUP:
+                        return copyable(static_cast<Group*>(expr)->m_expr, fun, size);
+                    case ExprKind::LITERAL:
+                        return true;
+                    case ExprKind::LOGIC: {
+                        Logic* logic = static_cast<Logic*>(expr);
+                        return copyable(logic->m_left, fun, size) && copyable(logic->m_right, fun, size);
+                    }
+                    case ExprKind::GET_VAR: {
+                        GetVar* get = static_cast<GetVar*>(expr);
+                        if (get->m_depth > 0) return true;
+                        return get->m_env.m_type == TokenType::NIL && get->m_slot < fun->m_parameters.size();
+                    }
+                    case ExprKind::CALL_FUN: {
+                        CallFun* call = static_cast<CallFun*>(expr);
+                        if (call->m_depth == 0) return false;
+                        if (call->m_env.m_type == TokenType::NIL && call->m_depth == 1 && call->m_slot == fun->m_slot) return false;
+                        for (Expr* argument: call->m_arguments) {
+                            if (!copyable(argument, fun, size)) return false;
+                        }
+                        return true;
+                    }
+                    default:
+                        return false;
+                }
+            }
+
+            //reads of each parameter, and whether the expression makes any call
+            static void count_uses(Expr* expr, std::vector<int>& uses, bool& calls) {
+                if (GetVar* get = expr_cast<GetVar>(expr)) {
+                    if (get->m_depth == 0) uses.at(get->m_slot)++;
+                } else if (Unary* unary = expr_cast<Unary>(expr)) {
+                    count_uses(unary->m_right, uses, calls);
+                } else if (Group* group = expr_cast<Group>(expr)) {
+                    count_uses(group->m_expr, uses, calls);
+                } else if (Binary* binary = expr_cast<Binary>(expr)) {
+                    count_uses(binary->m_left, uses, calls);
+                    count_uses(binary->m_right, uses, calls);
+                } else if (Logic* logic = expr_cast<Logic>(expr)) {
+                    count_uses(logic->m_left, uses, calls);
+                    count_uses(logic->m_right, uses, calls);
+                } else if (CallFun* call = expr_cast<CallFun>(expr)) {
+                    calls = true;
+                    for (Expr* argument: call->m_arguments) {
+                        count_uses(argument, uses, calls);
+                    }
+                }
+            }
+
+            //operators over literals and variables, leaving out integer division since it can fail
+            static bool pure(Expr* expr) {
+                switch(expr->m_kind) {
+                    case ExprKind::UNARY:
+                        return pure(static_cast<Unary*>(expr)->m_right);
+                    case ExprKind::BINARY: {
+                        Binary* binary = static_cast<Binary*>(expr);
+                        bool int_division = binary->m_data_type.m_type == TokenType::INT_TYPE &&
+                                            (binary->m_op.m_type == TokenType::SLASH || binary->m_op.m_type == TokenType::MOD);
+                        return !int_division && pure(binary->m_left) && pure(binary->m_right);
+                    }
+                    case ExprKind::GROUP:
+                        return pure(static_cast<Group*>(expr)->m_expr);
+                    case ExprKind::LITERAL:
+                        return true;
+                    case ExprKind::LOGIC: {
+                        Logic* logic = static_cast<Logic*>(expr);
+                        return pure(logic->m_left) && pure(logic->m_right);
+                    }
+                    case ExprKind::GET_VAR:
+                        return static_cast<GetVar*>(expr)->m_env.m_type == TokenType::NIL;
+                    default:
+                        return false;
+                }
+            }
+
+            /*
+             * Copy of an expression accepted by copyable(), with variables outside the body moved out by
+             * shift frames.  Parameters are replaced by copies of the arguments when they are given.
+             */
+            Expr* clone(Expr* expr, int shift, const std::vector<Expr*>* arguments) {
+                Expr* copy;
+                switch(expr->m_kind) {
+                    case ExprKind::UNARY: {
+                        Unary* unary = static_cast<Unary*>(expr);
+                        copy = m_arena.make<Unary>(unary->m_op, clone(unary->m_right, shift, arguments));
+                        break;
+                    }
+                    case ExprKind::BINARY: {
+                        Binary* binary = static_cast<Binary*>(expr);
+                        copy = m_arena.make<Binary>(binary->m_op, clone(binary->m_left, shift, arguments),
+                                                    clone(binary->m_right, shift, arguments));
+                        break;
+                    }
+                    case ExprKind::GROUP: {
+                        Group* group = static_cast<Group*>(expr);
+                        copy = m_arena.make<Group>(group->m_name, clone(group->m_expr, shift, arguments));
+                        break;
+                    }
+                    case ExprKind::LITERAL: {
+                        Literal* literal = m_arena.make<Literal>(static_cast<Literal*>(expr)->m_token);
+                        literal->m_value = static_cast<Literal*>(expr)->m_value;
+                        copy = literal;
+                        break;
+                    }
+                    case ExprKind::LOGIC: {
+                        Logic* logic = static_cast<Logic*>(expr);
+                        copy = m_arena.make<Logic>(logic->m_op, clone(logic->m_left, shift, arguments),
+                                                   clone(logic->m_right, shift, arguments));
+                        break;
+                    }
+                    case ExprKind::GET_VAR: {
+                        GetVar* get = static_cast<GetVar*>(expr);
+                        if (arguments && get->m_depth == 0) return clone(arguments->at(get->m_slot), 0, nullptr);
+
+                        GetVar* var = m_arena.make<GetVar>(get->m_name, get->m_env);
+                        var->m_depth = get->m_depth + shift;
+                        var->m_slot = get->m_slot;
+                        copy = var;
+                        break;
+                    }
+                    case ExprKind::CALL_FUN: {
+                        CallFun* call = static_cast<CallFun*>(expr);
+                        std::vector<Expr*> copied;
+                        for (Expr* argument: call->m_arguments) {
+                            copied.push_back(clone(argument, shift, arguments));
+                        }
+                        CallFun* fun = m_arena.make<CallFun>(call->m_name, call->m_env, m_arena.list(copied));
+                        fun->m_depth = call->m_depth + shift;
+                        fun->m_slot = call->m_slot;
+                        copy = fun;
+                        break;
+                    }
+                    default:
+                        return expr;
+                }
+                copy->m_data_type = expr->m_data_type;
+                return copy;
+            }
+
+            /*
+             * Folding
+             */
+            Literal* make_literal(const Token& at, const Value& value, DataType type) {
+                TokenType token_type;
+                switch(value.m_type) {
+                    case ValueType::INT: token_type = TokenType::INT; break;
+                    case ValueType::FLOAT: token_type = TokenType::FLOAT; break;
+                    case ValueType::STRING: token_type = TokenType::STRING; break;
+                    default: token_type = value.m_bool ? TokenType::TRUE : TokenType::FALSE; break;
+                }
+
+                Literal* literal = m_arena.make<Literal>(Token(token_type, nullptr, 0, at.m_line));
+                literal->m_value = value;
+                literal->m_data_type = type;
+                return literal;
+            }
+
+            //integer + - * wrap like the backends do; division by zero and INT_MIN / -1 are left for the runtime error
+            static bool fold_int(TokenType op, int a, int b, Value& result) {
+                switch(op) {
+                    case TokenType::PLUS: result = Value(int(unsigned(a) + unsigned(b))); return true;
+                    case TokenType::MINUS: result = Value(int(unsigned(a) - unsigned(b))); return true;
+                    case TokenType::STAR: result = Value(int(unsigned(a) * unsigned(b))); return true;
+                    case TokenType::SLASH:
+                    case TokenType::MOD:
+                        if (b == 0 || (a == INT_MIN && b == -1)) return false;
+                        result = Value(op == TokenType::SLASH ? a / b : a % b);
+                        return true;
+                    default: return false;
+                }
+            }
+
+            static bool fold_float(TokenType op, float a, float b, Value& result) {
+                switch(op) {
+                    case TokenType::PLUS: result = Value(a + b); return true;
+                    case TokenType::MINUS: result = Value(a - b); return true;
+                    case TokenType::STAR: result = Value(a * b); return true;
+                    case TokenType::SLASH: result = Value(a / b); return true;
+                    default: return false;
+                }
+            }
+
+            //same comparisons as the backends, floats within 0.01 of each other included
+            static bool fold_compare(TokenType op, const Value& a, const Value& b, Value& result) {
+                switch(a.m_type) {
+                    case ValueType::BOOL:
+                        if (op == TokenType::EQUAL_EQUAL) { result = Value(a.m_bool == b.m_bool); return true; }
+                        if (op == TokenType::BANG_EQUAL) { result = Value(a.m_bool != b.m_bool); return true; }
+                        return false;
+                    case ValueType::INT:
+                        switch(op) {
+                            case TokenType::EQUAL_EQUAL: result = Value(a.m_int == b.m_int); return true;
+                            case TokenType::BANG_EQUAL: result = Value(a.m_int != b.m_int); return true;
+                            case TokenType::LESS: result = Value(a.m_int < b.m_int); return true;
+                            case TokenType::LESS_EQUAL: result = Value(a.m_int <= b.m_int); return true;
+                            case TokenType::GREATER: result = Value(a.m_int > b.m_int); return true;
+                            case TokenType::GREATER_EQUAL: result = Value(a.m_int >= b.m_int); return true;
+                            default: return false;
+                        }
+                    case ValueType::FLOAT: {
+                        bool close = std::abs(a.m_float - b.m_float) < 0.01f;
+                        switch(op) {
+                            case TokenType::EQUAL_EQUAL: result = Value(close); return true;
+                            case TokenType::BANG_EQUAL: result = Value(!close); return true;
+                            case TokenType::LESS: result = Value(a.m_float < b.m_float); return true;
+                            case TokenType::LESS_EQUAL: result = Value(a.m_float < b.m_float || close); return true;
+                            case TokenType::GREATER: result = Value(a.m_float > b.m_float); return true;
+                            case TokenType::GREATER_EQUAL: result = Value(a.m_float > b.m_float || close); return true;
+                            default: return false;
+                        }
+                    }
+                    case ValueType::STRING:
+                        if (op == TokenType::EQUAL_EQUAL) { result = Value(a.as_string() == b.as_string()); return true; }
+                        if (op == TokenType::BANG_EQUAL) { result = Value(a.as_string() != b.as_string()); return true; }
+                        return false;
+                    default:
+                        return false;
+                }
+            }
+
+            //a folded expression is reported once as a whole rather than once per operator
+            Expr* folded(Expr* expr, const Token& op, size_t mark, Expr* result) {
+                m_notes.erase(m_notes.begin() + mark, m_notes.end());
+                note(op, "folded '" + describe(expr) + "' to " + describe(result) + ".");
+                return result;
+            }
+
+            static bool literal_bool(Expr* expr, bool& value) {
+                Literal* literal = expr_cast<Literal>(expr);
+                if (!literal || !literal->m_value.is_bool()) return false;
+                value = literal->m_value.m_bool;
+                return true;
+            }
+
+            /*
+             * Basic
+             */
+            Expr* visit(Unary* expr) {
+                size_t mark = m_notes.size();
+                Expr* right = optimize(expr->m_right);
+
+                if (Literal* literal = expr_cast<Literal>(right)) {
+                    const Value& v = literal->m_value;
+                    if (v.is_int()) return folded(expr, expr->m_op, mark, make_literal(expr->m_op, Value(int(0u - unsigned(v.m_int))), expr->m_data_type));
+                    if (v.is_float()) return folded(expr, expr->m_op, mark, make_literal(expr->m_op, Value(-v.m_float), expr->m_data_type));
+                    if (v.is_bool()) return folded(expr, expr->m_op, mark, make_literal(expr->m_op, Value(!v.m_bool), expr->m_data_type));
+                }
+
+                expr->m_right = right;
+                return expr;
+            }
+
+            Expr* visit(Binary* expr) {
+                size_t mark = m_notes.size();
+                Expr* left = optimize(expr->m_left);
+                Expr* right = optimize(expr->m_right);
+
+                Literal* a = expr_cast<Literal>(left);
+                Literal* b = expr_cast<Literal>(right);
+                if (a && b) {
+                    Value result;
+                    bool done = false;
+                    switch(expr->m_data_type.m_type) {
+                        case TokenType::INT_TYPE:
+                            done = fold_int(expr->m_op.m_type, a->m_value.m_int, b->m_value.m_int, result);
+                            break;
+                        case TokenType::FLOAT_TYPE:
+                            done = fold_float(expr->m_op.m_type, a->m_value.m_float, b->m_value.m_float, result);
+                            break;
+                        case TokenType::STRING_TYPE:
+                            result = Value(std::make_shared<String>(a->m_value.as_string() + b->m_value.as_string()));
+                            done = true;
+                            break;
+                        default:
+                            break;
+                    }
+                    if (done) return folded(expr, expr->m_op, mark, make_literal(expr->m_op, result, expr->m_data_type));
+                }
+
+                expr->m_left = left;
+                expr->m_right = right;
+                return expr;
+            }
+
+            //parentheses around a literal are dropped
+            Expr* visit(Group* expr) {
+                Expr* inner = optimize(expr->m_expr);
+                if (expr_cast<Literal>(inner)) return inner;
+
+                expr->m_expr = inner;
+                return expr;
+            }
+
+            Expr* visit(Literal* expr) {
+                return expr;
+            }
+
+            Expr* visit(Logic* expr) {
+                size_t mark = m_notes.size();
+                Expr* left = optimize(expr->m_left);
+                Expr* right = optimize(expr->m_right);
+
+                //a literal on the left decides whether the right side is the result
+                bool value;
+                if ((expr->m_op.m_type == TokenType::AND || expr->m_op.m_type == TokenType::OR) && literal_bool(left, value)) {
+                    bool is_and = expr->m_op.m_type == TokenType::AND;
+                    return folded(expr, expr->m_op, m_notes.size(), value == is_and ? right : left);
+                }
+
+                Literal* a = expr_cast<Literal>(left);
+                Literal* b = expr_cast<Literal>(right);
+                Value result;
+                if (a && b && fold_compare(expr->m_op.m_type, a->m_value, b->m_value, result)) {
+                    return folded(expr, expr->m_op, mark, make_literal(expr->m_op, result, expr->m_data_type));
+                }
+
+                expr->m_left = left;
+                expr->m_right = right;
+                return expr;
+            }
+
+            /*
+             * Variables and Functions
+             */
+            Expr* visit(DeclVar* expr) {
+                if (expr->m_value) expr->m_value = required(expr->m_value, expr->m_name);
+                return expr;
+            }
+
+            Expr* visit(GetVar* expr) {
+                return expr;
+            }
+
+            Expr* visit(SetVar* expr) {
+                expr->m_value = required(expr->m_value, expr->m_name);
+                return expr;
+            }
+
+            //parameters and body share the call frame
+            Expr* visit(DeclFun* expr) {
+                Block* body = expr_cast<Block>(expr->m_body);
+                body->m_expressions = statements(body->m_expressions, expr->m_slot_count);
+                return expr;
+            }
+
+            //the copy of an inlined body is optimized again, since literal arguments may fold it further
+            Expr* visit(CallFun* expr) {
+                for (Expr*& e: expr->m_arguments) {
+                    e = required(e, expr->m_name);
+                }
+
+                Expr* inlined = inline_call(expr);
+                return inlined ? optimize(inlined) : expr;
+            }
+
+            Expr* visit(Return* expr) {
+                if (expr->m_value) expr->m_value = required(expr->m_value, expr->m_name);
+                return expr;
+            }
+
+            /*
+             * Control Flow
+             */
+            Expr* visit(Block* expr) {
+                expr->m_expressions = statements(expr->m_expressions, expr->m_slot_count);
+                return expr;
+            }
+
+            Expr* visit(If* expr) {
+                Expr* condition = optimize(expr->m_condition);
+
+                bool value;
+                if (literal_bool(condition, value)) {
+                    if (value) {
+                        note(expr->m_name, "kept only the then branch of an if whose condition is always true.");
+                        return optimize(expr->m_then_branch);
+                    }
+                    note(expr->m_name, expr->m_else_branch ? "kept only the else branch of an if whose condition is always false."
+                                                           : "removed an if whose condition is always false.");
+                    return optimize(expr->m_else_branch);
+                }
+
+                expr->m_condition = condition;
+                expr->m_then_branch = required(expr->m_then_branch, expr->m_name);
+                expr->m_else_branch = optimize(expr->m_else_branch);
+                return expr;
+            }
+
+            //the initializer still runs, since it may declare a variable used after the loop
+            Expr* visit(For* expr) {
+                expr->m_initializer = optimize(expr->m_initializer);
+                Expr* condition = optimize(expr->m_condition);
+
+                bool value;
+                if (literal_bool(condition, value) && !value) {
+                    note(expr->m_name, "removed the body of a for loop whose condition is always false.");
+                    return expr->m_initializer;
+                }
+
+                expr->m_condition = condition;
+                expr->m_update = optimize(expr->m_update);
+                expr->m_body = required(expr->m_body, expr->m_name);
+                return expr;
+            }
+
+            Expr* visit(While* expr) {
+                Expr* condition = optimize(expr->m_condition);
+
+                bool value;
+                if (literal_bool(condition, value) && !value) {
+                    note(expr->m_name, "removed a while loop whose condition is always false.");
+                    return nullptr;
+                }
+
+                expr->m_condition = condition;
+                expr->m_body = required(expr->m_body, expr->m_name);
+                return expr;
+            }
+
+            /*
+             * Classes
+             */
+            //methods see the global frame and the method and field frames of the class, which never hold
+            //functions to inline since a subclass may override them
+            Expr* visit(DeclClass* expr) {
+                for (Expr* field: expr->m_fields) {
+                    optimize(field);
+                }
+
+                std::vector<std::unordered_map<int, DeclFun*>> method_frames(3);
+                method_frames.front() = m_frames.front();
+                std::swap(m_frames, method_frames);
+                for (Expr* method: expr->m_methods) {
+                    optimize(method);
+                }
+                std::swap(m_frames, method_frames);
+                return expr;
+            }
+
+            /*
+             * Notes
+             */
+            static std::string op_text(TokenType type) {
+                switch(type) {
+                    case TokenType::PLUS: return "+";
+                    case TokenType::MINUS: return "-";
+                    case TokenType::STAR: return "*";
+                    case TokenType::SLASH: return "/";
+                    case TokenType::MOD: return "%";
+                    case TokenType::EQUAL_EQUAL: return "==";
+                    case TokenType::BANG_EQUAL: return "!=";
+                    case TokenType::LESS: return "<";
+                    case TokenType::LESS_EQUAL: return "<=";
+                    case TokenType::GREATER: return ">";
+                    case TokenType::GREATER_EQUAL: return ">=";
+                    case TokenType::BANG: return "!";
+                    case TokenType::AND: return "and";
+                    case TokenType::OR: return "or";
+                    default: return Token::to_string(type);
+                }
+            }
+
+            //source-like text of an expression
+            static std::string describe(Expr* expr) {
+                if (Literal* literal = expr_cast<Literal>(expr)) {
+                    const Value& v = literal->m_value;
+                    std::ostringstream out;
+                    switch(v.m_type) {
+                        case ValueType::BOOL: out << (v.m_bool ? "true" : "false"); break;
+                        case ValueType::INT: out << v.m_int; break;
+                        case ValueType::FLOAT: out << v.m_float; break;
+                        case ValueType::STRING: out << std::quoted(v.as_string()); break;
+                        default: out << "nil"; break;
+                    }
+                    return out.str();
+                }
+                if (GetVar* get = expr_cast<GetVar>(expr)) {
+                    std::string name(get->m_name.lexeme());
+                    return get->m_env.m_type != TokenType::NIL ? std::string(get->m_env.lexeme()) + "." + name : name;
+                }
+                if (Group* group = expr_cast<Group>(expr)) {
+                    return "(" + describe(group->m_expr) + ")";
+                }
+                if (Unary* unary = expr_cast<Unary>(expr)) {
+                    return op_text(unary->m_op.m_type) + describe(unary->m_right);
+                }
+                if (Binary* binary = expr_cast<Binary>(expr)) {
+                    return describe(binary->m_left) + " " + op_text(binary->m_op.m_type) + " " + describe(binary->m_right);
+                }
+                if (Logic* logic = expr_cast<Logic>(expr)) {
+                    return describe(logic->m_left) + " " + op_text(logic->m_op.m_type) + " " + describe(logic->m_right);
+                }
+                if (CallFun* call = expr_cast<CallFun>(expr)) {
+                    return std::string(call->m_name.lexeme()) + "(...)";
+                }
+                return "...";
+            }
+    };
+
+}
+
+
+#endif // ZEBRA_OPTIMIZER_H
@@ -0,0 +1,98 @@
+#ifndef ZEBRA_PARALLEL_PARSER_H
+#define ZEBRA_PARALLEL_PARSER_H
+
+#include <vector>
+#include <memory>
+#include <thread>
+#include <algorithm>
+
+#include "Lexer.hpp"
+#include "Parser.hpp"
+#include "Expr.hpp"
+#include "ResultCode.hpp"
+
+namespace zebra {
+
+    /*
+     * Parses a large script as several slices at once.  The Lexer cuts the source at top-level
+     * declarations, and each slice is scanned and parsed on its own thread into its own arena,
+     * then the expression lists are joined in source order.  If any slice reports an error,
+     * including a cut that landed inside an unfinished expression, the whole script is parsed
+     * again on one thread, so diagnostics are exactly those of a sequential parse.
+     */
+    class ParallelParser {
+        public:
+            static constexpr size_t MIN_SLICE_SIZE = 1 << 20; //smaller scripts aren't worth a thread
+        private:
+            struct SliceParse {
+                Lexer m_lexer;
+                AstArena m_arena;
+                std::vector<Expr*> m_ast;
+                bool m_ok {false};
+                SliceParse(const Lexer& whole, const Lexer::Slice& slice): m_lexer(whole, slice.m_begin, slice.m_end, slice.m_line) {}
+            };
+
+            Lexer& m_lexer;
+            AstArena& m_arena;
+            std::vector<ParseError> m_errors;
+        public:
+            ParallelParser(Lexer& lexer, AstArena& arena): m_lexer(lexer), m_arena(arena) {}
+
+            //same contract as Parser::parse - syntax errors are left in the Lexer
+            ResultCode parse(std::vector<Expr*>& ast) {
+                size_t size = m_lexer.source().size();
+                size_t thread_count = std::max(1u, std::thread::hardware_concurrency());
+                if (thread_count > 1 && size >= 2 * MIN_SLICE_SIZE) {
+                    std::vector<Lexer::Slice> slices = m_lexer.split(std::max(MIN_SLICE_SIZE, size / thread_count));
+                    if (slices.size() > 1 && parse_slices(slices, ast)) {
+                        return ResultCode::SUCCESS;
+                    }
+                }
+
+                Parser parser(m_lexer, m_arena);
+                ResultCode result = parser.parse(ast);
+                m_errors = parser.get_errors();
+                return result;
+            }
+
+            std::vector<ParseError> get_errors() const {
+                return m_errors;
+            }
+
+        private:
+            bool parse_slices(const std::vector<Lexer::Slice>& slices, std::vector<Expr*>& ast) {
+                std::vector<std::unique_ptr<SliceParse>> parses;
+                for (const Lexer::Slice& slice: slices) {
+                    parses.push_back(std::make_unique<SliceParse>(m_lexer, slice));
+                }
+
+                auto work = [](SliceParse& p) {
+                    Parser parser(p.m_lexer, p.m_arena);
+                    p.m_ok = parser.parse(p.m_ast) == ResultCode::SUCCESS && p.m_lexer.get_errors().empty();
+                };
+
+                std::vector<std::thread> workers;
+                for (size_t i = 1; i < parses.size(); i++) {
+                    workers.emplace_back(work, std::ref(*parses.at(i)));
+                }
+                work(*parses.at(0));
+                for (std::thread& worker: workers) {
+                    worker.join();
+                }
+
+                for (const std::unique_ptr<SliceParse>& p: parses) {
+                    if (!p->m_ok) return false;
+                }
+
+                for (const std::unique_ptr<SliceParse>& p: parses) {
+                    m_arena.absorb(p->m_arena);
+                    ast.insert(ast.end(), p->m_ast.begin(), p->m_ast.end());
+                }
+                return true;
+            }
+    };
+
+}
+
+
+#endif // ZEBRA_PARALLEL_PARSER_H
@@ -4,6 +4,7 @@
 #include <vector>
 #include <iostream>
 #include "Token.hpp"
+#include "TokenStream.hpp"
 #include "Expr.hpp"
 #include "ResultCode.hpp"
 
@@ -13,30 +14,34 @@ namespace zebra {
         Token m_token;
         std::string m_message;
         ParseError(Token token, const std::string& message): m_token(token), m_message(message) {}
-        void print() {
-            std::cout << "[Line " << m_token.m_line << "] Parsing Error: " << m_message << std::endl;
+        void print(std::ostream& out = std::cout) {
+            out << "[Line " << m_token.m_line << "] Parsing Error: " << m_message << std::endl;
         }
     };
 
 
     class Parser {
         private:
-            std::vector<Token> m_tokens;
+            TokenStream m_tokens; //tokens are scanned as they are needed
+            AstArena& m_arena; //owns the nodes, kept by the caller for as long as the AST is used
             int m_current;
             //Note: doesn't check if return statement if valid (eg outside of function) - resolver should do that in next phase
             //Used for type checking for function and return
             TokenType m_return_type = TokenType::NIL_TYPE;
             bool m_had_return_flag = false;
+            bool m_skip_body = false; //set for top-level function declarations
             std::vector<ParseError> m_errors;
 
             bool m_error_flag {false};
 
         public:
-            Parser(const std::vector<Token>& tokens): m_tokens(tokens), m_current(0) {}
+            Parser(Lexer& lexer, AstArena& arena): m_tokens(lexer), m_arena(arena), m_current(0) {}
 
-            ResultCode parse(std::vector<std::shared_ptr<Expr>>& ast) {
+            ResultCode parse(std::vector<Expr*>& ast) {
                 while(!match(TokenType::EOFILE)) {
-                    std::shared_ptr<Expr> expr = expression();
+                    //top-level function bodies are only brace matched here and parsed later by BodyLoader
+                    m_skip_body = peek_three(TokenType::IDENTIFIER, TokenType::COLON_COLON, TokenType::LEFT_PAREN);
+                    Expr* expr = expression();
                     if (!m_error_flag) {
                         ast.push_back(expr);
                     } else {
@@ -52,6 +57,18 @@ namespace zebra {
                 }
             }
 
+            //parses a body skipped by parse(); the Lexer must start just past the body's '{'
+            ResultCode parse_body(DeclFun* decl) {
+                m_return_type = decl->m_return_type.m_type;
+                decl->m_body = function_body(decl->m_name, decl->m_body_start);
+
+                if (m_errors.empty()) {
+                    return ResultCode::SUCCESS;
+                } else {
+                    return ResultCode::FAILED;
+                }
+            }
+
             std::vector<ParseError> get_errors() const {
                 return m_errors;
             }
@@ -68,20 +85,20 @@ namespace zebra {
              * Expressions
              */
 
-            std::shared_ptr<Expr> expression() {
+            Expr* expression() {
                 return declare_assign();
             }
 
 
             //using two peeks here since an IDENTIFIER may be a function call, which has highest precedence
-            std::shared_ptr<Expr> declare_assign() {
+            Expr* declare_assign() {
                 //variable assignment
                 if (peek_two(TokenType::IDENTIFIER, TokenType::EQUAL)) {
                     match(TokenType::IDENTIFIER);
                     Token identifier = previous();
                     match(TokenType::EQUAL);
-                    std::shared_ptr<Expr> value = expression();
-                    return std::make_shared<SetVar>(identifier, Token(TokenType::NIL), value);
+                    Expr* value = expression();
+                    return m_arena.make<SetVar>(identifier, Token(TokenType::NIL), value);
                 //instance field assignment
                 } else if (peek_four(TokenType::IDENTIFIER, TokenType::DOT, TokenType::IDENTIFIER, TokenType::EQUAL)) {
                     match(TokenType::IDENTIFIER);
@@ -91,9 +108,9 @@ namespace zebra {
                     Token field = previous();
                     match(TokenType::EQUAL);
 
-                    std::shared_ptr<Expr> value = expression();
+                    Expr* value = expression();
 
-                    return std::make_shared<SetVar>(field, env, value);
+                    return m_arena.make<SetVar>(field, env, value);
                 } else if (peek_two(TokenType::IDENTIFIER, TokenType::COLON)) { //variable
                     match(TokenType::IDENTIFIER);
                     Token identifier = previous();
@@ -112,34 +129,34 @@ namespace zebra {
                     }
 
                     //check for possible assignment
-                    std::shared_ptr<Expr> value = nullptr;
+                    Expr* value = nullptr;
                     if(match(TokenType::EQUAL)) {
                         value = expression();
                     }
 
-                    return std::make_shared<DeclVar>(identifier, type, value);
+                    return m_arena.make<DeclVar>(identifier, type, value);
                 }
 
                 return logic_or();
             }
 
-            std::shared_ptr<Expr> logic_or() {
-                std::shared_ptr<Expr> left = logic_and();
+            Expr* logic_or() {
+                Expr* left = logic_and();
                 while(match(TokenType::OR)) {
                     Token op = previous();
-                    std::shared_ptr<Expr> right = logic_and();
-                    left = std::make_shared<Logic>(op, left, right);
+                    Expr* right = logic_and();
+                    left = m_arena.make<Logic>(op, left, right);
                 }
             
                 return left;             
             }
 
-            std::shared_ptr<Expr> logic_and() {
-                std::shared_ptr<Expr> left = equality();
+            Expr* logic_and() {
+                Expr* left = equality();
                 while(match(TokenType::AND)) {
                     Token op = previous();
-                    std::shared_ptr<Expr> right = equality();
-                    left = std::make_shared<Logic>(op, left, right);
+                    Expr* right = equality();
+                    left = m_arena.make<Logic>(op, left, right);
                 }
             
                 return left;             
@@ -147,78 +164,78 @@ namespace zebra {
 
             
             //== and !=
-            std::shared_ptr<Expr> equality() {
-                std::shared_ptr<Expr> left = inequality();
+            Expr* equality() {
+                Expr* left = inequality();
                 while(match(TokenType::EQUAL_EQUAL) || match(TokenType::BANG_EQUAL)) {
                     Token op = previous();
-                    std::shared_ptr<Expr> right = inequality();
-                    left = std::make_shared<Logic>(op, left, right);
+                    Expr* right = inequality();
+                    left = m_arena.make<Logic>(op, left, right);
                 }
             
                 return left;             
             }            
 
             //<, <=, >, >=
-            std::shared_ptr<Expr> inequality() {
-                std::shared_ptr<Expr> left = term();
+            Expr* inequality() {
+                Expr* left = term();
                 while(match(TokenType::LESS) || 
                       match(TokenType::LESS_EQUAL) ||
                       match(TokenType::GREATER) ||
                       match(TokenType::GREATER_EQUAL)) {
                     Token op = previous();
-                    std::shared_ptr<Expr> right = term();
-                    left = std::make_shared<Logic>(op, left, right);
+                    Expr* right = term();
+                    left = m_arena.make<Logic>(op, left, right);
                 }
             
                 return left;             
             }
 
-            std::shared_ptr<Expr> term() {
-                std::shared_ptr<Expr> left = factor();
+            Expr* term() {
+                Expr* left = factor();
                 while(match(TokenType::PLUS) || match(TokenType::MINUS)) {
                     Token op = previous();
-                    std::shared_ptr<Expr> right = factor();
-                    left = std::make_shared<Binary>(op, left, right);
+                    Expr* right = factor();
+                    left = m_arena.make<Binary>(op, left, right);
                 }
             
                 return left;             
             }
 
-            std::shared_ptr<Expr> factor() {
-                std::shared_ptr<Expr> left = unary();
+            Expr* factor() {
+                Expr* left = unary();
                 while(match(TokenType::STAR) || match(TokenType::SLASH) || match(TokenType::MOD)) {
                     Token op = previous();
-                    std::shared_ptr<Expr> right = unary();
-                    left = std::make_shared<Binary>(op, left, right);
+                    Expr* right = unary();
+                    left = m_arena.make<Binary>(op, left, right);
                 }
             
                 return left;             
             }
 
             //right associative
-            std::shared_ptr<Expr> unary() {
+            Expr* unary() {
                 if(match(TokenType::MINUS) || match(TokenType::BANG)) {
                     Token op = previous();
-                    std::shared_ptr<Expr> right = unary();
-                    return std::make_shared<Unary>(op, right);
+                    Expr* right = unary();
+                    return m_arena.make<Unary>(op, right);
                 }
 
                 return primary();
             }
 
-            std::shared_ptr<Expr> primary() {
+            Expr* primary() {
                 if (match(TokenType::FLOAT)) {
-                    return std::make_shared<Literal>(previous());
+                    return m_arena.make<Literal>(previous());
                 }else if(match(TokenType::INT)) {
-                    return std::make_shared<Literal>(previous());
+                    return m_arena.make<Literal>(previous());
                 }else if(match(TokenType::STRING)) {
-                    return std::make_shared<Literal>(previous());
+                    return m_arena.make<Literal>(previous());
                 }else if(match(TokenType::TRUE)) {
-                    return std::make_shared<Literal>(previous());
+                    return m_arena.make<Literal>(previous());
                 }else if(match(TokenType::FALSE)) {
-                    return std::make_shared<Literal>(previous());
+                    return m_arena.make<Literal>(previous());
                 }else if(match(TokenType::NIL)) {
-                    return std::make_shared<Literal>(previous());
+                    return m_arena.make<Literal>(previous());
                 }else if(peek_four(TokenType::IDENTIFIER, TokenType::DOT, TokenType::IDENTIFIER, TokenType::LEFT_PAREN)) {
                     match(TokenType::IDENTIFIER);
                     Token env = previous();
@@ -226,12 +243,12 @@ namespace zebra {
                     match(TokenType::IDENTIFIER);
                     Token fun = previous();
                     match(TokenType::LEFT_PAREN);
-                    std::vector<std::shared_ptr<Expr>> arguments;
-                    while (!match(TokenType::RIGHT_PAREN)) {
+                    std::vector<Expr*> arguments;
+                    while (!closes(TokenType::RIGHT_PAREN, "Expect ')' after arguments.")) {
                         arguments.push_back(expression());
                         match(TokenType::COMMA);
                     }
-                    return std::make_shared<CallFun>(fun, env, arguments);
+                    return m_arena.make<CallFun>(fun, env, m_arena.list(arguments));
                 }else if(peek_three(TokenType::IDENTIFIER, TokenType::DOT, TokenType::IDENTIFIER)) {
                     match(TokenType::IDENTIFIER);
                     Token env = previous();
@@ -239,72 +256,75 @@ namespace zebra {
                     match(TokenType::IDENTIFIER);
                     Token field = previous();
 
-                    return std::make_shared<GetVar>(field, env);
+                    return m_arena.make<GetVar>(field, env);
                 }else if(peek_two(TokenType::IDENTIFIER, TokenType::LEFT_PAREN)) {
                     match(TokenType::IDENTIFIER);
                     Token identifier = previous();
                     consume(TokenType::LEFT_PAREN, "Expected '(' after function identifier");
 
-                    std::vector<std::shared_ptr<Expr>> arguments;
-                    while(!match(TokenType::RIGHT_PAREN)) {
+                    std::vector<Expr*> arguments;
+                    while(!closes(TokenType::RIGHT_PAREN, "Expect ')' after arguments.")) {
                         arguments.emplace_back(expression());
                         match(TokenType::COMMA);
                     }
 
-                    return std::make_shared<CallFun>(identifier, Token(TokenType::NIL), arguments);
+                    return m_arena.make<CallFun>(identifier, Token(TokenType::NIL), m_arena.list(arguments));
                 }else if(match(TokenType::LEFT_PAREN)) {
                     Token t = previous();
-                    std::shared_ptr<Expr> expr = expression();
+                    Expr* expr = expression();
 
                     consume(TokenType::RIGHT_PAREN, "Expect closing parenthesis");
-                    return std::make_shared<Group>(t, expr);
+                    return m_arena.make<Group>(t, expr);
                 }else if(match(TokenType::LEFT_BRACE)) {
                     Token name = previous();
-                    std::vector<std::shared_ptr<Expr>> expressions;
-                    while (!match(TokenType::RIGHT_BRACE)) {
+                    std::vector<Expr*> expressions;
+                    while (!closes(TokenType::RIGHT_BRACE, "Expect '}' to close block.")) {
                         expressions.push_back(expression());
                     }
 
-                    return std::make_shared<Block>(name, expressions);
+                    return m_arena.make<Block>(name, m_arena.list(expressions));
                 } else if(match(TokenType::IF)) {
                     Token name = previous();
-                    std::shared_ptr<Expr> condition = expression();
-                    std::shared_ptr<Expr> then_branch = expression();
+                    Expr* condition = expression();
+                    Expr* then_branch = expression();
 
-                    std::shared_ptr<Expr> else_branch = nullptr;
+                    Expr* else_branch = nullptr;
                     if(match(TokenType::ELSE)) {
                         else_branch = expression();
                     }
-                    return std::make_shared<If>(name, condition, then_branch, else_branch);
+                    return m_arena.make<If>(name, condition, then_branch, else_branch);
                 } else if(match(TokenType::FOR)) {
                     Token name = previous();
 
-                    std::shared_ptr<Expr> initializer;
+                    Expr* initializer;
                     if(!match(TokenType::COMMA)) {
                         initializer = expression();
                         consume(TokenType::COMMA, "Expecting comma after initializer.");
                     }
 
-                    std::shared_ptr<Expr> condition;
+                    Expr* condition;
                     if(!match(TokenType::COMMA)) {
                         condition = expression();
                         consume(TokenType::COMMA, "Expecting comma after condition.");
                     }
 
-                    std::shared_ptr<Expr> update;
+                    Expr* update;
                     if(!match(TokenType::LEFT_BRACE)) {
                         update = expression();
                     }
 
-                    std::shared_ptr<Expr> body = expression();
+                    Expr* body = expression();
 
-                    return std::make_shared<For>(name, initializer, condition, update, body);
+                    return m_arena.make<For>(name, initializer, condition, update, body);
                 } else if(match(TokenType::WHILE)) {
                     Token name = previous();
-                    std::shared_ptr<Expr> condition = expression();
-                    std::shared_ptr<Expr> body = expression();
-                    return std::make_shared<While>(name, condition, body);
+                    Expr* condition = expression();
+                    Expr* body = expression();
+                    return m_arena.make<While>(name, condition, body);
                 } else if(peek_three(TokenType::IDENTIFIER, TokenType::COLON_COLON, TokenType::LEFT_PAREN)) {
+                    bool skip_body = m_skip_body;
+                    m_skip_body = false;
+
                     match(TokenType::IDENTIFIER);
                     Token identifier = previous();
                     match(TokenType::COLON_COLON);
@@ -312,8 +332,8 @@ namespace zebra {
                     //parameter list
                     consume(TokenType::LEFT_PAREN, "Expect '(' before function parameters.");
 
-                    std::vector<std::shared_ptr<Expr>> parameters;
-                    while(!match(TokenType::RIGHT_PAREN)) {
+                    std::vector<Expr*> parameters;
+                    while(!closes(TokenType::RIGHT_PAREN, "Expect ')' after parameters.")) {
                         match(TokenType::IDENTIFIER);
                         Token name = previous();
 
@@ -332,7 +352,7 @@ namespace zebra {
                             add_error(type, "Invalid parameter type.");
                         }
 
-                        parameters.emplace_back(std::make_shared<DeclVar>(name, type, nullptr));
+                        parameters.emplace_back(m_arena.make<DeclVar>(name, type, nullptr));
                         match(TokenType::COMMA);                    
                     }                
 
@@ -343,30 +363,25 @@ namespace zebra {
                     match(TokenType::STRING_TYPE);
                     match(TokenType::FUN_TYPE);
                     match(TokenType::IDENTIFIER);
-                    if (previous().m_type == TokenType::RIGHT_ARROW) {
-                        m_return_type = TokenType::NIL_TYPE;
-                    } else {
-                        m_return_type = previous().m_type; 
+                    Token return_type = previous();
+                    if (return_type.m_type == TokenType::RIGHT_ARROW) {
+                        return_type = Token(TokenType::NIL_TYPE, nullptr, 0, return_type.m_line);
                     }
+                    m_return_type = return_type.m_type;
 
                     consume(TokenType::LEFT_BRACE, "Expect '{' to start new block.");
 
                     Token name = previous(); //block name
 
-                    //setting flag to default false, will be set to true if return statement in body
-                    m_had_return_flag = false;
-
-                    std::vector<std::shared_ptr<Expr>> expressions;
-                    while (!match(TokenType::RIGHT_BRACE)) {
-                        expressions.push_back(expression());
-                    }
-
-                    if (m_return_type != TokenType::NIL_TYPE && !m_had_return_flag) {
-                        add_error(identifier, "Expect return statement.");
+                    if (skip_body && name.m_type == TokenType::LEFT_BRACE) {
+                        skip_block(name);
+                        DeclFun* decl = m_arena.make<DeclFun>(identifier, m_arena.list(parameters), return_type, nullptr);
+                        decl->m_body_start = name;
+                        return decl;
                     }
 
-                    std::shared_ptr<Expr> body = std::make_shared<Block>(name, expressions);
-                    return std::make_shared<DeclFun>(identifier, parameters, m_return_type, body);
+                    Expr* body = function_body(identifier, name);
+                    return m_arena.make<DeclFun>(identifier, m_arena.list(parameters), return_type, body);
                 } else if(peek_three(TokenType::IDENTIFIER, TokenType::COLON_COLON, TokenType::CLASS)) {
                     match(TokenType::IDENTIFIER);
                     Token name = previous();
@@ -381,30 +396,30 @@ namespace zebra {
                     }
 
                     consume(TokenType::LEFT_BRACE, "Expect '{' before class body.");
-                    std::vector<std::shared_ptr<Expr>> fields;
-                    std::vector<std::shared_ptr<Expr>> methods;
-                    while (!match(TokenType::RIGHT_BRACE)) {
-                        std::shared_ptr<Expr> decl = expression();
+                    std::vector<Expr*> fields;
+                    std::vector<Expr*> methods;
+                    while (!closes(TokenType::RIGHT_BRACE, "Expect '}' after class body.")) {
+                        Expr* decl = expression();
                         
                         //either a DeclVar or DeclFun
-                        if (dynamic_cast<DeclVar*>(decl.get())) {
+                        if (expr_cast<DeclVar>(decl)) {
                             fields.push_back(decl);
                         } else {
                             methods.push_back(decl);
                         }
                     }
 
-                    return std::make_shared<DeclClass>(name, base, fields, methods);
+                    return m_arena.make<DeclClass>(name, base, m_arena.list(fields), m_arena.list(methods));
                 } else if(match(TokenType::RIGHT_ARROW)) {
                     m_had_return_flag = true;
                     Token name = previous();
-                    std::shared_ptr<Expr> value = nullptr;
+                    Expr* value = nullptr;
                     if (m_return_type != TokenType::NIL_TYPE) {
                         value = expression();
                     }
-                    return std::make_shared<Return>(name, value);
+                    return m_arena.make<Return>(name, value);
                 } else if (match(TokenType::IDENTIFIER)) {
-                    return std::make_shared<GetVar>(previous(), Token(TokenType::NIL));
+                    return m_arena.make<GetVar>(previous(), Token(TokenType::NIL));
                 }
 
                 add_error(previous(), "Expecting an expression.");
@@ -412,6 +427,40 @@ namespace zebra {
             }
 
 
+            //statements up to the closing '}', with the opening '{' already consumed
+            Expr* function_body(const Token& identifier, const Token& name) {
+                //setting flag to default false, will be set to true if return statement in body
+                m_had_return_flag = false;
+
+                std::vector<Expr*> expressions;
+                while (!closes(TokenType::RIGHT_BRACE, "Expect '}' to close function body.")) {
+                    expressions.push_back(expression());
+                }
+
+                if (m_return_type != TokenType::NIL_TYPE && !m_had_return_flag) {
+                    add_error(identifier, "Expect return statement.");
+                }
+
+                return m_arena.make<Block>(name, m_arena.list(expressions));
+            }
+
+            //steps over a body without building any nodes, with the opening '{' already consumed
+            void skip_block(const Token& name) {
+                int depth = 1;
+                while (depth > 0) {
+                    if (match(TokenType::LEFT_BRACE)) {
+                        depth++;
+                    } else if (match(TokenType::RIGHT_BRACE)) {
+                        depth--;
+                    } else if (peek_one(TokenType::EOFILE)) {
+                        add_error(name, "Expect '}' to close function body.");
+                        return;
+                    } else {
+                        m_current++;
+                    }
+                }
+            }
+
             bool match(TokenType type) {
                 if(m_tokens.at(m_current).m_type == type) {
                     m_current++;
@@ -420,22 +469,19 @@ namespace zebra {
                 return false;
             }
 
+            //the stream repeats EOFILE past the end of the source, so lookahead needs no bounds checks
             bool peek_one(TokenType type) {
-                if (m_current >= m_tokens.size()) return false;
                 return m_tokens.at(m_current).m_type == type;
             }
             bool peek_two(TokenType type1, TokenType type2) {
-                if (m_current + 1 >= m_tokens.size()) return false;
                 return peek_one(type1) && (m_tokens.at(m_current + 1).m_type == type2);
             }
 
             bool peek_three(TokenType type1, TokenType type2, TokenType type3) {
-                if (m_current + 2 >= m_tokens.size()) return false;
                 return peek_two(type1, type2) && (m_tokens.at(m_current + 2).m_type == type3);
             }
 
             bool peek_four(TokenType type1, TokenType type2, TokenType type3, TokenType type4) {
-                if (m_current + 3 >= m_tokens.size()) return false;
                 return peek_three(type1, type2, type3) && (m_tokens.at(m_current + 3).m_type == type4);
             }
 
@@ -443,6 +489,20 @@ namespace zebra {
                 return m_tokens.at(m_current - 1);
             }
 
+            /*
+             * Ends a loop over a list or block: true once the closing token is matched, and also at the
+             * end of the source, reported with the message, or after an error inside the list, which
+             * leaves the parser stuck on the token it couldn't parse.
+             */
+            bool closes(TokenType type, const std::string& message) {
+                if (match(type)) return true;
+                if (peek_one(TokenType::EOFILE)) {
+                    if (!m_error_flag) add_error(previous(), message);
+                    return true;
+                }
+                return m_error_flag;
+            }
+
             void consume(TokenType type, const std::string& message) {
                 if (!match(type)) {
                     Token t = previous();
@@ -0,0 +1,352 @@
+#ifndef ZEBRA_RESOLVER_H
+#define ZEBRA_RESOLVER_H
+
+#include <vector>
+#include <unordered_map>
+#include <iostream>
+#include <stdexcept>
+
+#include "Token.hpp"
+#include "Expr.hpp"
+#include "ResultCode.hpp"
+#include "Library.hpp"
+
+namespace zebra {
+
+    struct ResolveError {
+        Token m_token;
+        std::string m_message;
+        ResolveError(Token token, const std::string& message): m_token(token), m_message(message) {}
+        void print(std::ostream& out = std::cout) {
+            out << "[Line " << m_token.m_line << "] Resolve Error: " << m_message << std::endl;
+        }
+    };
+
+
+    /*
+     * Assigns every declaration a slot in its frame and every variable reference a
+     * (depth, slot) pair, so the backends never look variables up by name.
+     *
+     * Frames created at runtime must line up with the scopes here:
+     *  global - natives followed by top-level declarations
+     *  block - locals declared in the block
+     *  function - parameters followed by locals declared in the body block
+     *  methods - one frame per class holding its methods, inherited ones included
+     *  fields - one frame per instance holding its fields, inherited ones included
+     *  Method bodies see their own frame, the instance fields, the class methods and the global frame.
+     *  Inherited members keep the base class slots so base class methods work on any subclass instance.
+     */
+    class Resolver {
+        friend struct ExprDispatch;
+        private:
+            struct ClassInfo {
+                int m_base = Symbols::NONE;
+                std::vector<int> m_fields;
+                std::vector<int> m_methods;
+            };
+            struct Scope {
+                std::unordered_map<int, int> m_slots;
+                std::unordered_map<int, ClassInfo> m_classes;
+                int m_count = 0;
+            };
+            std::vector<Scope> m_scopes;
+            std::vector<ResolveError> m_errors;
+        public:
+            Resolver() {
+                push_scope();
+                for (const std::pair<std::string, std::shared_ptr<Callable>>& native: native_functions()) {
+                    declare(Symbols::intern(native.first));
+                }
+            }
+
+            ~Resolver() {}
+
+            ResultCode resolve(const std::vector<Expr*>& ast) {
+                for (Expr* expr: ast) {
+                    resolve(expr);
+                }
+
+                if (m_errors.empty()) {
+                    return ResultCode::SUCCESS;
+                } else {
+                    return ResultCode::FAILED;
+                }
+            }
+
+            std::vector<ResolveError> get_errors() const {
+                return m_errors;
+            }
+
+            //natives and top-level declarations, for passes that add slots of their own
+            int global_slot_count() const {
+                return m_scopes.front().m_count;
+            }
+
+        private:
+            void resolve(Expr* expr) {
+                ExprDispatch::visit(*this, expr);
+            }
+
+            void add_error(Token token, const std::string& message) {
+                m_errors.emplace_back(token, message);
+            }
+
+            void push_scope() {
+                m_scopes.emplace_back();
+            }
+
+            void pop_scope() {
+                m_scopes.pop_back();
+            }
+
+            //redeclaring a name in the same scope reuses its slot
+            int declare(int name) {
+                Scope& scope = m_scopes.back();
+                auto it = scope.m_slots.find(name);
+                if (it != scope.m_slots.end()) return it->second;
+
+                scope.m_slots[name] = scope.m_count;
+                return scope.m_count++;
+            }
+
+            bool resolve_name(const Token& name, int& depth, int& slot) {
+                for (int i = int(m_scopes.size()) - 1; i >= 0; i--) {
+                    auto it = m_scopes.at(i).m_slots.find(name.m_symbol);
+                    if (it != m_scopes.at(i).m_slots.end()) {
+                        depth = int(m_scopes.size()) - 1 - i;
+                        slot = it->second;
+                        return true;
+                    }
+                }
+
+                add_error(name, "Undefined reference to '" + std::string(name.lexeme()) + "'.");
+                return false;
+            }
+
+            ClassInfo* find_class(int name) {
+                for (int i = int(m_scopes.size()) - 1; i >= 0; i--) {
+                    auto it = m_scopes.at(i).m_classes.find(name);
+                    if (it != m_scopes.at(i).m_classes.end()) return &it->second;
+                }
+                return nullptr;
+            }
+
+            //parameters and body share a single frame
+            void resolve_function(DeclFun* expr) {
+                push_scope();
+                for (Expr* param: expr->m_parameters) {
+                    DeclVar* decl_var = expr_cast<DeclVar>(param);
+                    decl_var->m_slot = declare(decl_var->m_name.m_symbol);
+                }
+
+                for (Expr* e: expr_cast<Block>(expr->m_body)->m_expressions) {
+                    resolve(e);
+                }
+
+                expr->m_slot_count = m_scopes.back().m_count;
+                pop_scope();
+            }
+
+            /*
+             * Basic
+             */
+            void visit(Unary* expr) {
+                resolve(expr->m_right);
+            }
+
+            void visit(Binary* expr) {
+                resolve(expr->m_left);
+                resolve(expr->m_right);
+            }
+
+            void visit(Group* expr) {
+                resolve(expr->m_expr);
+            }
+
+            //literals are converted once here rather than every time they are evaluated
+            void visit(Literal* expr) {
+                switch(expr->m_token.m_type) {
+                    case TokenType::FLOAT:
+                        try {
+                            expr->m_value = Value(std::stof(std::string(expr->m_token.lexeme())));
+                        } catch (const std::out_of_range&) {
+                            add_error(expr->m_token, "Float literal out of range.");
+                        }
+                        break;
+                    case TokenType::INT:
+                        try {
+                            expr->m_value = Value(std::stoi(std::string(expr->m_token.lexeme())));
+                        } catch (const std::out_of_range&) {
+                            add_error(expr->m_token, "Integer literal out of range.");
+                        }
+                        break;
+                    case TokenType::STRING:
+                        expr->m_value = Value(std::make_shared<String>(std::string(expr->m_token.lexeme())));
+                        break;
+                    case TokenType::TRUE:
+                        expr->m_value = Value(true);
+                        break;
+                    case TokenType::FALSE:
+                        expr->m_value = Value(false);
+                        break;
+                    default:
+                        expr->m_value = Value();
+                        break;
+                }
+            }
+
+            void visit(Logic* expr) {
+                resolve(expr->m_left);
+                resolve(expr->m_right);
+            }
+
+            /*
+             * Variables and Functions
+             */
+            void visit(DeclVar* expr) {
+                //initializer is resolved first so it can refer to a shadowed outer variable
+                if (expr->m_value) resolve(expr->m_value);
+                expr->m_slot = declare(expr->m_name.m_symbol);
+            }
+
+            void visit(GetVar* expr) {
+                if (expr->m_env.m_type != TokenType::NIL) {
+                    resolve_name(expr->m_env, expr->m_depth, expr->m_slot);
+                } else {
+                    resolve_name(expr->m_name, expr->m_depth, expr->m_slot);
+                }
+            }
+
+            void visit(SetVar* expr) {
+                resolve(expr->m_value);
+                if (expr->m_env.m_type != TokenType::NIL) {
+                    resolve_name(expr->m_env, expr->m_depth, expr->m_slot);
+                } else {
+                    resolve_name(expr->m_name, expr->m_depth, expr->m_slot);
+                }
+            }
+
+            void visit(DeclFun* expr) {
+                //declared before the body is resolved to allow recursion
+                expr->m_slot = declare(expr->m_name.m_symbol);
+                resolve_function(expr);
+            }
+
+            void visit(CallFun* expr) {
+                for (Expr* e: expr->m_arguments) {
+                    resolve(e);
+                }
+
+                if (expr->m_env.m_type != TokenType::NIL) {
+                    resolve_name(expr->m_env, expr->m_depth, expr->m_slot);
+                } else {
+                    resolve_name(expr->m_name, expr->m_depth, expr->m_slot);
+                }
+            }
+
+            void visit(Return* expr) {
+                if (expr->m_value) resolve(expr->m_value);
+            }
+
+            /*
+             * Control Flow
+             */
+            void visit(Block* expr) {
+                push_scope();
+                for (Expr* e: expr->m_expressions) {
+                    resolve(e);
+                }
+                expr->m_slot_count = m_scopes.back().m_count;
+                pop_scope();
+            }
+
+            void visit(If* expr) {
+                resolve(expr->m_condition);
+                resolve(expr->m_then_branch);
+                if (expr->m_else_branch) resolve(expr->m_else_branch);
+            }
+
+            void visit(For* expr) {
+                if (expr->m_initializer) resolve(expr->m_initializer);
+                if (expr->m_condition) resolve(expr->m_condition);
+                if (expr->m_update) resolve(expr->m_update);
+                resolve(expr->m_body);
+            }
+
+            void visit(While* expr) {
+                resolve(expr->m_condition);
+                resolve(expr->m_body);
+            }
+
+            /*
+             * Classes
+             */
+            void visit(DeclClass* expr) {
+                //field initializers are evaluated in the scope declaring the class
+                for (Expr* field: expr->m_fields) {
+                    DeclVar* decl_var = expr_cast<DeclVar>(field);
+                    if (decl_var->m_value) resolve(decl_var->m_value);
+                }
+
+                ClassInfo info;
+                if (expr->m_base.m_type != TokenType::NIL) {
+                    resolve_name(expr->m_base, expr->m_base_depth, expr->m_base_slot);
+                    if (!find_class(expr->m_base.m_symbol)) {
+                        add_error(expr->m_base, "'" + std::string(expr->m_base.lexeme()) + "' is not a class.");
+                        return;
+                    }
+                    info.m_base = expr->m_base.m_symbol;
+                }
+
+                //layouts start from the base class so inherited members keep their slots
+                if (ClassInfo* base = find_class(info.m_base)) {
+                    info.m_fields = base->m_fields;
+                    info.m_methods = base->m_methods;
+                }
+                for (Expr* field: expr->m_fields) {
+                    DeclVar* decl_var = expr_cast<DeclVar>(field);
+                    decl_var->m_slot = declare_member(info.m_fields, decl_var->m_name.m_symbol);
+                }
+                for (Expr* method: expr->m_methods) {
+                    DeclFun* decl_fun = expr_cast<DeclFun>(method);
+                    decl_fun->m_slot = declare_member(info.m_methods, decl_fun->m_name.m_symbol);
+                }
+
+                expr->m_slot = declare(expr->m_name.m_symbol);
+                m_scopes.back().m_classes[expr->m_name.m_symbol] = info;
+
+                std::vector<Scope> method_scopes;
+                method_scopes.push_back(m_scopes.front());
+                method_scopes.push_back(member_scope(info.m_methods));
+                method_scopes.push_back(member_scope(info.m_fields));
+
+                std::swap(m_scopes, method_scopes);
+                for (Expr* method: expr->m_methods) {
+                    resolve_function(expr_cast<DeclFun>(method));
+                }
+                std::swap(m_scopes, method_scopes);
+            }
+
+            //redeclaring a member, including an inherited one, reuses its slot
+            int declare_member(std::vector<int>& members, int name) {
+                for (int i = 0; i < int(members.size()); i++) {
+                    if (members.at(i) == name) return i;
+                }
+                members.push_back(name);
+                return int(members.size()) - 1;
+            }
+
+            Scope member_scope(const std::vector<int>& members) {
+                Scope scope;
+                for (int name: members) {
+                    scope.m_slots[name] = scope.m_count++;
+                }
+                return scope;
+            }
+
+    };
+
+}
+
+
+#endif // ZEBRA_RESOLVER_H
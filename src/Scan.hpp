@@ -0,0 +1,133 @@
+#ifndef ZEBRA_SCAN_H
+#define ZEBRA_SCAN_H
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define ZEBRA_SCAN_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace zebra {
+
+    /*
+     * Scanning kernels used by the Lexer for the long runs in a script: blanks, identifiers,
+     * string literals and comments.  With SSE2 they test 16 bytes at a time, otherwise they fall
+     * back to the equivalent byte loop.  Each returns the index of the first byte in
+     * [pos, end) that stops the run, or end.
+     */
+    namespace scan {
+
+        inline bool is_identifier_char(char c) {
+            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+        }
+
+        inline bool is_special(char c, char stop1, char stop2) {
+            return c == stop1 || c == stop2 || (unsigned char)(c) >= 0x80;
+        }
+
+#ifdef ZEBRA_SCAN_SSE2
+        inline int first_set_bit(unsigned mask) {
+#if defined(_MSC_VER)
+            unsigned long index;
+            _BitScanForward(&index, mask);
+            return int(index);
+#else
+            return __builtin_ctz(mask);
+#endif
+        }
+
+        //bytes are compared as signed, so non-ASCII bytes are below every range and fail the test
+        inline __m128i in_range(__m128i bytes, char low, char high) {
+            return _mm_and_si128(_mm_cmpgt_epi8(bytes, _mm_set1_epi8(char(low - 1))),
+                                 _mm_cmpgt_epi8(_mm_set1_epi8(char(high + 1)), bytes));
+        }
+#endif
+
+        //end of a run of spaces and carriage returns; newlines are left to the caller to count lines
+        inline size_t skip_blanks(const char* data, size_t pos, size_t end) {
+#ifdef ZEBRA_SCAN_SSE2
+            for (; pos + 16 <= end; pos += 16) {
+                __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+                __m128i ok = _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(' ')),
+                                          _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\r')));
+                unsigned stop = ~unsigned(_mm_movemask_epi8(ok)) & 0xffff;
+                if (stop) return pos + first_set_bit(stop);
+            }
+#endif
+            while (pos < end && (data[pos] == ' ' || data[pos] == '\r')) pos++;
+            return pos;
+        }
+
+        //end of a run of [A-Za-z0-9_]
+        inline size_t skip_identifier(const char* data, size_t pos, size_t end) {
+#ifdef ZEBRA_SCAN_SSE2
+            for (; pos + 16 <= end; pos += 16) {
+                __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+                __m128i lower = _mm_or_si128(bytes, _mm_set1_epi8(0x20));
+                __m128i ok = _mm_or_si128(_mm_or_si128(in_range(lower, 'a', 'z'), in_range(bytes, '0', '9')),
+                                          _mm_cmpeq_epi8(bytes, _mm_set1_epi8('_')));
+                unsigned stop = ~unsigned(_mm_movemask_epi8(ok)) & 0xffff;
+                if (stop) return pos + first_set_bit(stop);
+            }
+#endif
+            while (pos < end && is_identifier_char(data[pos])) pos++;
+            return pos;
+        }
+
+        //first of either stop character or any non-ASCII byte, which the caller validates as UTF-8
+        inline size_t find_special(const char* data, size_t pos, size_t end, char stop1, char stop2) {
+#ifdef ZEBRA_SCAN_SSE2
+            for (; pos + 16 <= end; pos += 16) {
+                __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+                __m128i hit = _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(stop1)),
+                                           _mm_cmpeq_epi8(bytes, _mm_set1_epi8(stop2)));
+                unsigned stop = unsigned(_mm_movemask_epi8(hit)) | unsigned(_mm_movemask_epi8(bytes));
+                if (stop) return pos + first_set_bit(stop);
+            }
+#endif
+            while (pos < end && !is_special(data[pos], stop1, stop2)) pos++;
+            return pos;
+        }
+
+        //length of the well-formed UTF-8 sequence starting at data[pos], or 0 if it is malformed
+        inline int utf8_sequence_length(const char* data, size_t pos, size_t end) {
+            const unsigned char* s = reinterpret_cast<const unsigned char*>(data + pos);
+            size_t available = end - pos;
+            unsigned char lead = s[0];
+
+            int len;
+            unsigned char second_low = 0x80, second_high = 0xbf;
+            if (lead >= 0xc2 && lead <= 0xdf) {
+                len = 2;
+            } else if (lead >= 0xe0 && lead <= 0xef) {
+                len = 3;
+                if (lead == 0xe0) second_low = 0xa0;  //overlong
+                if (lead == 0xed) second_high = 0x9f; //surrogates
+            } else if (lead >= 0xf0 && lead <= 0xf4) {
+                len = 4;
+                if (lead == 0xf0) second_low = 0x90;  //overlong
+                if (lead == 0xf4) second_high = 0x8f; //above U+10FFFF
+            } else {
+                return 0;
+            }
+
+            if (available < size_t(len)) return 0;
+            if (s[1] < second_low || s[1] > second_high) return 0;
+            for (int i = 2; i < len; i++) {
+                if ((s[i] & 0xc0) != 0x80) return 0;
+            }
+            return len;
+        }
+
+    }
+
+}
+
+
+#endif // ZEBRA_SCAN_H
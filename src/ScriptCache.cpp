@@ -0,0 +1,234 @@
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+#include <vector>
+#include "ScriptCache.hpp"
+#include "Object.hpp"
+#include "Symbol.hpp"
+
+namespace zebra {
+
+    namespace {
+
+        const char MAGIC[4] = {'Z', 'B', 'C', '\0'};
+
+        /*
+         * Fixed width fields in host byte order - cache files are only read back on the machine
+         * that wrote them.
+         */
+        class CacheWriter {
+            public:
+                std::string m_buffer;
+            public:
+                template <typename T>
+                void write(T value) {
+                    m_buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+                }
+
+                void write_bytes(const void* data, size_t size) {
+                    write(uint32_t(size));
+                    m_buffer.append(static_cast<const char*>(data), size);
+                }
+
+                //false if the chunk holds a constant that cannot be saved
+                bool write_chunk(const Chunk& chunk) {
+                    write_bytes(chunk.m_code.data(), chunk.m_code.size());
+                    write_bytes(chunk.m_lines.data(), chunk.m_lines.size() * sizeof(int));
+
+                    write(uint32_t(chunk.m_names.size()));
+                    for (const Token& name: chunk.m_names) {
+                        write(int32_t(name.m_line));
+                        write_bytes(name.m_start, name.m_length);
+                    }
+
+                    write(uint32_t(chunk.m_caches.size()));
+
+                    write(uint32_t(chunk.m_constants.size()));
+                    for (const Value& constant: chunk.m_constants) {
+                        if (!write_value(constant)) return false;
+                    }
+                    return true;
+                }
+            private:
+                bool write_value(const Value& value) {
+                    write(uint8_t(value.m_type));
+                    switch(value.m_type) {
+                        case ValueType::NIL: return true;
+                        case ValueType::BOOL: write(uint8_t(value.m_bool)); return true;
+                        case ValueType::INT: write(int32_t(value.m_int)); return true;
+                        case ValueType::FLOAT: write(value.m_float); return true;
+                        case ValueType::STRING: {
+                            const std::string& s = value.as_string();
+                            write_bytes(s.data(), s.size());
+                            return true;
+                        }
+                        case ValueType::OBJECT: {
+                            //the compiler only emits functions as object constants
+                            FunDef* fun = value.as<FunDef>();
+                            if (!fun || !fun->m_chunk) return false;
+                            write(int32_t(fun->m_slot_count));
+                            return write_chunk(*fun->m_chunk);
+                        }
+                    }
+                    return false;
+                }
+        };
+
+        //every read is bounds checked, and a short or corrupt file marks the reader as failed
+        class CacheReader {
+            private:
+                const char* m_pos;
+                const char* m_end;
+                bool m_ok {true};
+            public:
+                CacheReader(const char* data, size_t size): m_pos(data), m_end(data + size) {}
+
+                bool ok() const { return m_ok; }
+                bool at_end() const { return m_pos == m_end; }
+
+                template <typename T>
+                T read() {
+                    T value {};
+                    if (!take(sizeof(T))) return value;
+                    std::memcpy(&value, m_pos - sizeof(T), sizeof(T));
+                    return value;
+                }
+
+                //view of the next length prefixed field
+                std::string_view read_bytes() {
+                    uint32_t size = read<uint32_t>();
+                    if (!take(size)) return std::string_view();
+                    return std::string_view(m_pos - size, size);
+                }
+
+                std::shared_ptr<Chunk> read_chunk() {
+                    std::shared_ptr<Chunk> chunk = std::make_shared<Chunk>();
+
+                    std::string_view code = read_bytes();
+                    chunk->m_code.assign(code.begin(), code.end());
+                    std::string_view lines = read_bytes();
+                    chunk->m_lines.resize(lines.size() / sizeof(int));
+                    std::memcpy(chunk->m_lines.data(), lines.data(), chunk->m_lines.size() * sizeof(int));
+
+                    uint32_t name_count = read<uint32_t>();
+                    for (uint32_t i = 0; i < name_count && m_ok; i++) {
+                        int line = read<int32_t>();
+                        int symbol = Symbols::intern(read_bytes());
+                        //lexemes point at the interned name, since there is no source buffer to view
+                        const std::string& name = Symbols::name(symbol);
+                        Token token(TokenType::IDENTIFIER, name.data(), uint32_t(name.size()), line);
+                        token.m_symbol = symbol;
+                        chunk->add_name(token);
+                    }
+
+                    uint32_t cache_count = read<uint32_t>();
+                    for (uint32_t i = 0; i < cache_count && m_ok; i++) {
+                        chunk->add_cache();
+                    }
+
+                    uint32_t constant_count = read<uint32_t>();
+                    for (uint32_t i = 0; i < constant_count && m_ok; i++) {
+                        chunk->add_constant(read_value());
+                    }
+
+                    if (chunk->m_lines.size() != chunk->m_code.size()) m_ok = false;
+                    return m_ok ? chunk : nullptr;
+                }
+            private:
+                bool take(size_t size) {
+                    if (!m_ok || size_t(m_end - m_pos) < size) {
+                        m_ok = false;
+                        return false;
+                    }
+                    m_pos += size;
+                    return true;
+                }
+
+                Value read_value() {
+                    switch(ValueType(read<uint8_t>())) {
+                        case ValueType::NIL: return Value();
+                        case ValueType::BOOL: return Value(read<uint8_t>() != 0);
+                        case ValueType::INT: return Value(int(read<int32_t>()));
+                        case ValueType::FLOAT: return Value(read<float>());
+                        case ValueType::STRING: return Value(std::make_shared<String>(std::string(read_bytes())));
+                        case ValueType::OBJECT: {
+                            int slot_count = read<int32_t>();
+                            std::shared_ptr<Chunk> chunk = read_chunk();
+                            if (!chunk) break;
+                            //the VM only needs the slot count and bytecode, not the declaration
+                            return Value(std::make_shared<FunDef>(ExprList(), nullptr, slot_count, chunk));
+                        }
+                    }
+                    m_ok = false;
+                    return Value();
+                }
+        };
+
+    }
+
+    std::shared_ptr<Chunk> ScriptCache::load(std::string_view source) {
+        std::error_code ec;
+        uintmax_t size = std::filesystem::file_size(m_path, ec);
+        if (ec) return nullptr;
+
+        //one sized read, same as the Lexer does for sources
+        std::ifstream file(m_path, std::ios::binary);
+        std::string buffer(size_t(size), '\0');
+        if (!file.read(buffer.data(), std::streamsize(size))) return nullptr;
+
+        CacheReader reader(buffer.data(), buffer.size());
+        char magic[4];
+        for (int i = 0; i < 4; i++) {
+            magic[i] = reader.read<char>();
+        }
+        if (std::memcmp(magic, MAGIC, 4) != 0 ||
+            reader.read<uint32_t>() != VERSION ||
+            reader.read<uint64_t>() != uint64_t(source.size()) ||
+            reader.read<uint64_t>() != hash(source)) {
+            return nullptr;
+        }
+
+        std::shared_ptr<Chunk> chunk = reader.read_chunk();
+        if (!reader.ok() || !reader.at_end()) return nullptr;
+        return chunk;
+    }
+
+    ResultCode ScriptCache::store(std::string_view source, const Chunk& chunk) {
+        CacheWriter writer;
+        for (int i = 0; i < 4; i++) {
+            writer.write(MAGIC[i]);
+        }
+        writer.write(VERSION);
+        writer.write(uint64_t(source.size()));
+        writer.write(hash(source));
+        if (!writer.write_chunk(chunk)) return ResultCode::FAILED;
+
+        //written beside the cache and renamed over it, so a concurrent run never reads half a file
+        std::string temp_path = m_path + ".tmp";
+        {
+            std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+            if (!file.write(writer.m_buffer.data(), std::streamsize(writer.m_buffer.size()))) {
+                return ResultCode::FAILED;
+            }
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(temp_path, m_path, ec);
+        if (ec) {
+            std::filesystem::remove(temp_path, ec);
+            return ResultCode::FAILED;
+        }
+        return ResultCode::SUCCESS;
+    }
+
+    //64-bit FNV-1a
+    uint64_t ScriptCache::hash(std::string_view source) {
+        uint64_t h = 14695981039346656037ull;
+        for (char c: source) {
+            h ^= uint8_t(c);
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+
+}
@@ -0,0 +1,40 @@
+#ifndef ZEBRA_SCRIPT_CACHE_H
+#define ZEBRA_SCRIPT_CACHE_H
+
+#include <string>
+#include <string_view>
+#include <memory>
+#include <cstdint>
+
+#include "Chunk.hpp"
+#include "ResultCode.hpp"
+
+namespace zebra {
+
+    /*
+     * Compiled bytecode for a script, saved next to it as <script>.zbc.  The file records the
+     * format version and a hash of the source it was compiled from, so an edited script or a
+     * newer build of zebra falls back to a full compile and overwrites the stale cache.
+     */
+    class ScriptCache {
+        public:
+            //bump whenever OpCode, the native function slots or the layout written by store() change,
+            //or when the frontend starts emitting better code that old caches should pick up
+            static const uint32_t VERSION = 3;
+        private:
+            std::string m_path;
+        public:
+            ScriptCache(const std::string& script_path): m_path(script_path + ".zbc") {}
+            ~ScriptCache() {}
+
+            //nullptr if there is no usable cache for this source
+            std::shared_ptr<Chunk> load(std::string_view source);
+            ResultCode store(std::string_view source, const Chunk& chunk);
+        private:
+            static uint64_t hash(std::string_view source);
+    };
+
+}
+
+
+#endif // ZEBRA_SCRIPT_CACHE_H
@@ -0,0 +1,116 @@
+#ifndef ZEBRA_SYMBOL_H
+#define ZEBRA_SYMBOL_H
+
+#include <string>
+#include <string_view>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+
+namespace zebra {
+
+    /*
+     * Interned identifier names.  The Lexer gives every identifier a symbol, so later stages
+     * hash and compare small integers rather than strings.  Symbols are shared by every
+     * script loaded in the process, and scripts are scanned on several threads at once.
+     *
+     * Names already interned are found without locking: the lookup table is an open addressed
+     * array of atomic pointers to entries that never change once published.  Adding a name takes
+     * the lock, and a full table is replaced by a larger copy while the old one is kept for any
+     * thread still probing it.
+     */
+    class Symbols {
+        public:
+            static const int NONE = -1;
+        private:
+            struct Entry {
+                std::string m_name;
+                int m_id;
+                Entry(std::string_view name, int id): m_name(name), m_id(id) {}
+            };
+            struct Table {
+                std::unique_ptr<std::atomic<const Entry*>[]> m_slots;
+                size_t m_mask;
+                Table(size_t capacity): m_slots(new std::atomic<const Entry*>[capacity]), m_mask(capacity - 1) {
+                    for (size_t i = 0; i < capacity; i++) {
+                        m_slots[i].store(nullptr, std::memory_order_relaxed);
+                    }
+                }
+            };
+
+            std::deque<Entry> m_entries; //by id; deque never moves its elements, so tables can point at them
+            std::vector<std::unique_ptr<Table>> m_tables; //every table ever published, the last is current
+            std::atomic<Table*> m_current;
+            std::mutex m_mutex;
+        public:
+            static int intern(std::string_view name) {
+                Symbols& table = instance();
+                size_t hash = std::hash<std::string_view>()(name);
+                if (const Entry* entry = find(*table.m_current.load(std::memory_order_acquire), name, hash)) {
+                    return entry->m_id;
+                }
+
+                //another thread may have added the name since the lookup
+                std::lock_guard<std::mutex> lock(table.m_mutex);
+                Table* current = table.m_current.load(std::memory_order_relaxed);
+                if (const Entry* entry = find(*current, name, hash)) return entry->m_id;
+
+                //kept at most half full so probes stay short
+                if (2 * (table.m_entries.size() + 1) > current->m_mask + 1) current = table.grow();
+                table.m_entries.emplace_back(name, int(table.m_entries.size()));
+                insert(*current, &table.m_entries.back(), hash);
+                return table.m_entries.back().m_id;
+            }
+
+            static const std::string& name(int symbol) {
+                static const std::string none = "";
+                if (symbol == NONE) return none;
+                Symbols& table = instance();
+                std::lock_guard<std::mutex> lock(table.m_mutex);
+                return table.m_entries.at(symbol).m_name;
+            }
+        private:
+            Symbols() {
+                m_tables.push_back(std::make_unique<Table>(1024));
+                m_current.store(m_tables.back().get(), std::memory_order_relaxed);
+            }
+
+            static Symbols& instance() {
+                static Symbols table;
+                return table;
+            }
+
+            static const Entry* find(const Table& table, std::string_view name, size_t hash) {
+                for (size_t i = hash & table.m_mask; ; i = (i + 1) & table.m_mask) {
+                    const Entry* entry = table.m_slots[i].load(std::memory_order_acquire);
+                    if (!entry || entry->m_name == name) return entry;
+                }
+            }
+
+            //only called with the lock held, so slots are claimed by one thread at a time
+            static void insert(Table& table, const Entry* entry, size_t hash) {
+                size_t i = hash & table.m_mask;
+                while (table.m_slots[i].load(std::memory_order_relaxed)) {
+                    i = (i + 1) & table.m_mask;
+                }
+                table.m_slots[i].store(entry, std::memory_order_release);
+            }
+
+            Table* grow() {
+                Table* current = m_current.load(std::memory_order_relaxed);
+                m_tables.push_back(std::make_unique<Table>(2 * (current->m_mask + 1)));
+                Table* larger = m_tables.back().get();
+                for (const Entry& entry: m_entries) {
+                    insert(*larger, &entry, std::hash<std::string_view>()(entry.m_name));
+                }
+                m_current.store(larger, std::memory_order_release);
+                return larger;
+            }
+    };
+
+}
+
+
+#endif // ZEBRA_SYMBOL_H
@@ -2,16 +2,22 @@
 #define ZEBRA_TOKEN_H
 
 #include <string>
+#include <string_view>
+#include <cstdint>
 #include "TokenType.hpp"
+#include "Symbol.hpp"
 
 
 namespace zebra {
 
     struct Token {
         public:
-            TokenType m_type;
-            std::string m_lexeme;
+            //lexeme points into the source buffer owned by the Lexer, which must outlive the AST
+            const char* m_start;
+            uint32_t m_length;
             int m_line;
+            int m_symbol {Symbols::NONE}; //interned lexeme, set by the Lexer for identifiers
+            TokenType m_type;
         public:
             static std::string to_string(TokenType type) {
                 switch(type) {
@@ -75,16 +81,19 @@ namespace zebra {
                 }
             }
         public:
-            Token(): m_type(TokenType::NIL), m_lexeme(""), m_line(-1) {}
-            Token(TokenType type): m_type(type), m_lexeme(""), m_line(-1) {}
-            Token(TokenType type, const std::string& lexeme): m_type(type), m_lexeme(lexeme), m_line(-1) {}
-            Token(TokenType type, const std::string& lexeme, int line): m_type(type), m_lexeme(lexeme), m_line(line) {}
-            ~Token() {}
+            Token(): m_start(nullptr), m_length(0), m_line(-1), m_type(TokenType::NIL) {}
+            Token(TokenType type): m_start(nullptr), m_length(0), m_line(-1), m_type(type) {}
+            Token(TokenType type, const char* start, uint32_t length, int line): 
+                m_start(start), m_length(length), m_line(line), m_type(type) {}
+
+            std::string_view lexeme() const {
+                return std::string_view(m_start, m_length);
+            }
 
-            std::string to_string() {
+            std::string to_string() const {
                 std::string token = Token::to_string(m_type);
-                if (m_lexeme != "") {
-                    return token + " [" + m_lexeme + "]";
+                if (m_length > 0) {
+                    return token + " [" + std::string(lexeme()) + "]";
                 } else {
                     return token;
                 }
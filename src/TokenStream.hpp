@@ -0,0 +1,39 @@
+#ifndef ZEBRA_TOKEN_STREAM_H
+#define ZEBRA_TOKEN_STREAM_H
+
+#include <assert.h>
+
+#include "Token.hpp"
+#include "Lexer.hpp"
+
+namespace zebra {
+
+    /*
+     * Tokens pulled from the Lexer as the Parser asks for them.  Only the most recent few are
+     * kept, in a ring buffer indexed by their absolute position in the stream, so memory stays
+     * proportional to the Parser's lookahead rather than to the length of the script.
+     */
+    class TokenStream {
+        public:
+            static const int CAPACITY = 8; //power of two, covers previous() plus four tokens of lookahead
+        private:
+            Lexer& m_lexer;
+            Token m_ring[CAPACITY];
+            int m_produced {0};
+        public:
+            TokenStream(Lexer& lexer): m_lexer(lexer) {}
+
+            const Token& at(int index) {
+                while (m_produced <= index) {
+                    m_ring[m_produced & (CAPACITY - 1)] = m_lexer.next_token();
+                    m_produced++;
+                }
+                assert(index > m_produced - CAPACITY && "token already dropped from the lookahead window");
+                return m_ring[index & (CAPACITY - 1)];
+            }
+    };
+
+}
+
+
+#endif // ZEBRA_TOKEN_STREAM_H
@@ -10,6 +10,7 @@
 #include "Expr.hpp"
 #include "ResultCode.hpp"
 #include "DataType.hpp"
+#include "Library.hpp"
 
 namespace zebra {
 
@@ -21,34 +22,39 @@ namespace zebra {
         public:
             TypeError(Token token, const std::string& message): m_token(token), m_message(message){}
             ~TypeError() {}
-            void print() {
-                std::cout << "[Line " << m_token.m_line << "] Type Error: " << m_message << std::endl;
+            void print(std::ostream& out = std::cout) {
+                out << "[Line " << m_token.m_line << "] Type Error: " << m_message << std::endl;
             }
     };
 
 
-    class Typer: public DataTypeVisitor {
+    class Typer {
+        friend struct ExprDispatch;
         private:
             struct ClassSig {
-                std::string m_base_name = "";
-                std::unordered_map<std::string, DataType> m_field_sig;
-                std::unordered_map<std::string, std::vector<DataType>> m_method_sig;
+                int m_base = Symbols::NONE;
+                std::unordered_map<int, DataType> m_field_sig;
+                std::unordered_map<int, std::vector<DataType>> m_method_sig;
             };
-            std::vector<std::unordered_map<std::string, ClassSig>> m_class_sig;
-            std::vector<std::unordered_map<std::string, DataType>> m_var_sig;
-            std::vector<std::unordered_map<std::string, std::vector<DataType>>> m_fun_sig;
+            std::vector<std::unordered_map<int, ClassSig>> m_class_sig;
+            std::vector<std::unordered_map<int, DataType>> m_var_sig;
+            std::vector<std::unordered_map<int, std::vector<DataType>>> m_fun_sig;
+            std::vector<DataType> m_return_types; //declared return type of each enclosing function
             std::vector<TypeError> m_errors;
         public:
             Typer() {
                 push_scope();
+                for (const std::pair<std::string, std::shared_ptr<Callable>>& native: native_functions()) {
+                    m_fun_sig.back()[Symbols::intern(native.first)] = native.second->m_signature;
+                }
             }
 
             ~Typer() {}
 
             void push_scope() {
-                m_var_sig.emplace_back(std::unordered_map<std::string, DataType>()); 
-                m_fun_sig.emplace_back(std::unordered_map<std::string, std::vector<DataType>>()); 
-                m_class_sig.emplace_back(std::unordered_map<std::string, ClassSig>());
+                m_var_sig.emplace_back(std::unordered_map<int, DataType>()); 
+                m_fun_sig.emplace_back(std::unordered_map<int, std::vector<DataType>>()); 
+                m_class_sig.emplace_back(std::unordered_map<int, ClassSig>());
             }
 
             void pop_scope() {
@@ -57,90 +63,124 @@ namespace zebra {
                 m_class_sig.pop_back();
             }
 
-            DataType find_var_sig(const std::string& lexeme) {
+            DataType find_var_sig(int symbol) {
                 for (int i = m_var_sig.size() - 1; i >= 0; i--) {
-                    if (m_var_sig.at(i).count(lexeme) > 0) 
-                        return m_var_sig.at(i)[lexeme];
+                    if (m_var_sig.at(i).count(symbol) > 0) 
+                        return m_var_sig.at(i)[symbol];
                     else
                         continue;
                 }
+                return DataType(TokenType::ERROR);
             }
 
-            std::vector<DataType> find_fun_sig(const std::string& lexeme) {
+            std::vector<DataType> find_fun_sig(int symbol) {
                 for (int i = m_fun_sig.size() - 1; i >= 0; i--) {
-                    if (m_fun_sig.at(i).count(lexeme) > 0) 
-                        return m_fun_sig.at(i)[lexeme];
+                    if (m_fun_sig.at(i).count(symbol) > 0) 
+                        return m_fun_sig.at(i)[symbol];
                     else
                         continue;
                 }
+                return std::vector<DataType>();
             }
 
-            ClassSig find_class_sig(const std::string& lexeme) {
+            ClassSig find_class_sig(int symbol) {
                 for (int i = m_class_sig.size() - 1; i >= 0; i--) {
-                    if (m_class_sig.at(i).count(lexeme) > 0) 
-                        return m_class_sig.at(i)[lexeme];
+                    if (m_class_sig.at(i).count(symbol) > 0) 
+                        return m_class_sig.at(i)[symbol];
                     else
                         continue;
                 } 
+                return ClassSig();
             }
 
-            bool is_declared_field(const std::string& class_name, const std::string& field) {
+            bool is_declared_field(int class_name, int field) {
                 ClassSig class_sig = find_class_sig(class_name);
-                for (std::pair<std::string, DataType> p: class_sig.m_field_sig) {
+                for (std::pair<int, DataType> p: class_sig.m_field_sig) {
                     if (p.first == field) 
                         return true;
                 }
 
-                if (class_sig.m_base_name != "") {
-                    return is_declared_field(class_sig.m_base_name, field);
+                if (class_sig.m_base != Symbols::NONE) {
+                    return is_declared_field(class_sig.m_base, field);
                 }
 
                 return false;
             }
 
-            DataType get_field_sig(const std::string& class_name, const std::string& field) {
+            DataType get_field_sig(int class_name, int field) {
                 ClassSig class_sig = find_class_sig(class_name);
-                for (std::pair<std::string, DataType> p: class_sig.m_field_sig) {
+                for (std::pair<int, DataType> p: class_sig.m_field_sig) {
                     if (p.first == field) 
                         return p.second;
                 }
 
-                if (class_sig.m_base_name != "") {
-                    return get_field_sig(class_sig.m_base_name, field);
+                if (class_sig.m_base != Symbols::NONE) {
+                    return get_field_sig(class_sig.m_base, field);
                 }
 
+                return DataType(TokenType::ERROR);
             }
 
-            bool is_declared_method(const std::string& class_name, const std::string& method) {
+            bool is_declared_method(int class_name, int method) {
                 ClassSig class_sig = find_class_sig(class_name);
-                for (std::pair<std::string, std::vector<DataType>> p: class_sig.m_method_sig) {
+                for (std::pair<int, std::vector<DataType>> p: class_sig.m_method_sig) {
                     if (p.first == method) 
                         return true;
                 }
 
-                if (class_sig.m_base_name != "") {
-                    return is_declared_method(class_sig.m_base_name, method);
+                if (class_sig.m_base != Symbols::NONE) {
+                    return is_declared_method(class_sig.m_base, method);
                 }
 
                 return false;
             }
 
-            std::vector<DataType> get_method_sig(const std::string& class_name, const std::string& method) {
+            std::vector<DataType> get_method_sig(int class_name, int method) {
                 ClassSig class_sig = find_class_sig(class_name); 
 
-                for (std::pair<std::string, std::vector<DataType>> p: class_sig.m_method_sig) {
+                for (std::pair<int, std::vector<DataType>> p: class_sig.m_method_sig) {
                     if (p.first == method) 
                         return p.second;
                 }
 
-                if (class_sig.m_base_name != "") {
-                    return get_method_sig(class_sig.m_base_name, method);
+                if (class_sig.m_base != Symbols::NONE) {
+                    return get_method_sig(class_sig.m_base, method);
+                }
+
+                return std::vector<DataType>();
+            }
+
+            //instances of a derived class can be used where the base class is expected
+            bool is_assignable(const DataType& target, const DataType& value) {
+                if (DataType::equal(target, value)) return true;
+                if (target.m_type != TokenType::IDENTIFIER || value.m_type != TokenType::IDENTIFIER) return false;
+
+                int base = find_class_sig(value.m_symbol).m_base;
+                while (base != Symbols::NONE) {
+                    if (base == target.m_symbol) return true;
+                    base = find_class_sig(base).m_base;
                 }
+                return false;
             }
 
-            bool is_declared_var(const std::string& lexeme) {
+            //base class members first so fields and methods redeclared in a derived class shadow them
+            void declare_members(int class_name) {
+                if (class_name == Symbols::NONE || !is_declared_class(class_name)) return;
+
+                ClassSig class_sig = find_class_sig(class_name);
+                declare_members(class_sig.m_base);
+
+                for (std::pair<int, DataType> p: class_sig.m_field_sig) {
+                    m_var_sig.back()[p.first] = p.second;
+                }
+                for (std::pair<int, std::vector<DataType>> p: class_sig.m_method_sig) {
+                    m_fun_sig.back()[p.first] = p.second;
+                }
+            }
+
+            bool is_declared_var(int symbol) {
                 for (int i = m_var_sig.size() - 1; i >= 0; i--) {
-                    if (m_var_sig.at(i).count(lexeme) > 0) 
+                    if (m_var_sig.at(i).count(symbol) > 0) 
                         return true;
                     else
                         continue;
@@ -148,9 +188,9 @@ namespace zebra {
                 return false;
             }
 
-            bool is_declared_fun(const std::string& lexeme) {
+            bool is_declared_fun(int symbol) {
                 for (int i = m_fun_sig.size() - 1; i >= 0; i--) {
-                    if (m_fun_sig.at(i).count(lexeme) > 0) 
+                    if (m_fun_sig.at(i).count(symbol) > 0) 
                         return true;
                     else
                         continue;
@@ -159,9 +199,9 @@ namespace zebra {
                 return false;
             }
 
-            bool is_declared_class(const std::string& lexeme) {
+            bool is_declared_class(int symbol) {
                 for (int i = m_class_sig.size() - 1; i >= 0; i--) {
-                    if (m_class_sig.at(i).count(lexeme) > 0) 
+                    if (m_class_sig.at(i).count(symbol) > 0) 
                         return true;
                     else
                         continue;
@@ -171,9 +211,9 @@ namespace zebra {
             }
 
 
-            ResultCode type(const std::vector<std::shared_ptr<Expr>>& ast) {
-                for(std::shared_ptr<Expr> expr: ast) {
-                    evaluate(expr.get());
+            ResultCode type(const std::vector<Expr*>& ast) {
+                for(Expr* expr: ast) {
+                    evaluate(expr);
                 }
 
                 if (m_errors.empty()) {
@@ -186,8 +226,35 @@ namespace zebra {
                 return m_errors;
             }
         private:
+            //every typed node keeps its type so the backends can pick type-specialized operations
             DataType evaluate(Expr* expr) {
-                return expr->accept(*this);
+                DataType dt = ExprDispatch::visit(*this, expr);
+                expr->m_data_type = dt;
+                return dt;
+            }
+
+            //parameters and body statements share one scope, matching the function frame
+            void check_function(DeclFun* expr) {
+                push_scope();
+
+                for(Expr* e: expr->m_parameters) {
+                    DeclVar* decl_var = expr_cast<DeclVar>(e);
+                    m_var_sig.back()[decl_var->m_name.m_symbol] = DataType(decl_var->m_type.m_type, type_name(decl_var->m_type));
+                }
+
+                m_return_types.push_back(DataType(expr->m_return_type.m_type, type_name(expr->m_return_type)));
+                Block* block = expr_cast<Block>(expr->m_body);
+                for (Expr* e: block->m_expressions) {
+                    evaluate(e);
+                }
+                m_return_types.pop_back();
+
+                pop_scope();
+            }
+
+            //class types carry the class name, primitive types don't
+            static int type_name(const Token& type) {
+                return type.m_type == TokenType::IDENTIFIER ? type.m_symbol : Symbols::NONE;
             }
 
             void add_error(Token token, const std::string& message) {
@@ -198,11 +265,11 @@ namespace zebra {
              * Basic
              */
             DataType visit(Unary* expr) {
-                DataType right_type = evaluate(expr->m_right.get());
+                DataType right_type = evaluate(expr->m_right);
 
                 if (right_type.m_type == TokenType::IDENTIFIER) {
                     add_error(expr->m_op, expr->m_op.to_string() + " operator does not work on " +
-                                          right_type.m_lexeme + " data types.");
+                                          right_type.name() + " data types.");
                     return DataType(TokenType::ERROR);
                 }
 
@@ -210,9 +277,13 @@ namespace zebra {
                     case TokenType::MINUS:
                         if(right_type.m_type == TokenType::INT_TYPE || right_type.m_type == TokenType::FLOAT_TYPE)
                             return right_type;
+                        break;
                     case TokenType::BANG:
                         if(right_type.m_type == TokenType::BOOL_TYPE)
                             return right_type;
+                        break;
+                    default:
+                        break;
                 }
 
                 add_error(expr->m_op, "Cannot use " + 
@@ -224,20 +295,23 @@ namespace zebra {
             }
 
             DataType visit(Binary* expr) {
-                DataType left = evaluate(expr->m_left.get());
-                DataType right = evaluate(expr->m_right.get());
+                DataType left = evaluate(expr->m_left);
+                DataType right = evaluate(expr->m_right);
 
                 if (left.m_type == TokenType::IDENTIFIER ||
                     right.m_type == TokenType::IDENTIFIER) {
                     add_error(expr->m_op, "Cannot use " + expr->m_op.to_string() +
-                                          " operator with a " + left.m_lexeme + 
-                                          " and a " + right.m_lexeme + ".");
+                                          " operator with a " + left.name() + 
+                                          " and a " + right.name() + ".");
                     return DataType(TokenType::ERROR);
                 }
 
-                if (left.m_type == right.m_type && 
-                    left.m_type != TokenType::BOOL_TYPE &&
-                    left.m_type != TokenType::IDENTIFIER) return left;
+                bool numeric = left.m_type == TokenType::INT_TYPE || left.m_type == TokenType::FLOAT_TYPE;
+                bool valid_op = (numeric && expr->m_op.m_type != TokenType::MOD) ||
+                                (left.m_type == TokenType::INT_TYPE && expr->m_op.m_type == TokenType::MOD) ||
+                                (left.m_type == TokenType::STRING_TYPE && expr->m_op.m_type == TokenType::PLUS);
+
+                if (left.m_type == right.m_type && valid_op) return left;
 
                 add_error(expr->m_op, "Cannot use " + expr->m_op.to_string() + 
                                       " operator with a " + Token::to_string(left.m_type) + 
@@ -246,7 +320,7 @@ namespace zebra {
             }
 
             DataType visit(Group* expr) {
-                return evaluate(expr->m_expr.get());
+                return evaluate(expr->m_expr);
             }
 
             DataType visit(Literal* expr) {
@@ -260,6 +334,10 @@ namespace zebra {
                         return DataType(TokenType::INT_TYPE);
                     case TokenType::STRING:
                         return DataType(TokenType::STRING_TYPE);
+                    case TokenType::NIL:
+                        return DataType(TokenType::NIL_TYPE);
+                    default:
+                        break;
                 }
 
                 add_error(expr->m_token, expr->m_token.to_string() + 
@@ -269,18 +347,18 @@ namespace zebra {
 
             // ==, !=, <, <=, >, >=, and, or
             DataType visit(Logic* expr) {
-                DataType left = evaluate(expr->m_left.get());
-                DataType right = evaluate(expr->m_right.get());
+                DataType left = evaluate(expr->m_left);
+                DataType right = evaluate(expr->m_right);
 
                 if (left.m_type == TokenType::IDENTIFIER ||
                     right.m_type == TokenType::IDENTIFIER) {
                     add_error(expr->m_op, "Cannot use " + expr->m_op.to_string() +
-                                          " operator with a " + left.m_lexeme + 
-                                          " and a " + right.m_lexeme + ".");
+                                          " operator with a " + left.name() + 
+                                          " and a " + right.name() + ".");
                     return DataType(TokenType::ERROR);
                 }
 
-                if (left.m_type != right.m_type) {
+                if (left.m_type != right.m_type || left.m_type == TokenType::NIL_TYPE) {
                     add_error(expr->m_op, "Cannot use " + expr->m_op.to_string() + 
                                           " with " + Token::to_string(left.m_type) + 
                                           " and " + Token::to_string(right.m_type) + ".");
@@ -317,25 +395,24 @@ namespace zebra {
              */
 
             DataType visit(DeclVar* expr) {
-                if (expr->m_value) {
-                    if (evaluate(expr->m_value.get()).m_type != expr->m_type.m_type) {
-                        add_error(expr->m_name, "Right hand side of " + 
-                                                expr->m_name.to_string() + 
-                                                " must evaluate to " + 
-                                                expr->m_type.to_string() + ".");
-                        return DataType(TokenType::ERROR);
-                    }
-                } else {
+                if (!expr->m_value) {
                     add_error(expr->m_name, expr->m_name.to_string() + 
                                             " must be defined at declaration.");
                     return DataType(TokenType::ERROR);
                 }
 
-                DataType dt = evaluate(expr->m_value.get());
+                DataType dt = DataType(expr->m_type.m_type, type_name(expr->m_type));
+                if (!is_assignable(dt, evaluate(expr->m_value))) {
+                    add_error(expr->m_name, "Right hand side of " + 
+                                            expr->m_name.to_string() + 
+                                            " must evaluate to " + 
+                                            expr->m_type.to_string() + ".");
+                    return DataType(TokenType::ERROR);
+                }
 
-                m_var_sig.back()[expr->m_name.m_lexeme] = dt;
+                m_var_sig.back()[expr->m_name.m_symbol] = dt;
 
-                return DataType(expr->m_type.m_type);
+                return dt;
             }
 
             DataType visit(GetVar* expr) {
@@ -344,41 +421,41 @@ namespace zebra {
                  */
                 if (expr->m_env.m_type != TokenType::NIL) {
                     //is instance declared?
-                    if (!is_declared_var(expr->m_env.m_lexeme)) {
-                        add_error(expr->m_env, expr->m_env.m_lexeme + " is not declared.");
+                    if (!is_declared_var(expr->m_env.m_symbol)) {
+                        add_error(expr->m_env, std::string(expr->m_env.lexeme()) + " is not declared.");
                         return DataType(TokenType::ERROR);
                     }
 
-                    DataType dt = find_var_sig(expr->m_env.m_lexeme);
+                    DataType dt = find_var_sig(expr->m_env.m_symbol);
 
                     //is class declared?
-                    if (!is_declared_class(dt.m_lexeme)) {
-                        add_error(expr->m_env, dt.m_lexeme + " is not declared class.");
+                    if (!is_declared_class(dt.m_symbol)) {
+                        add_error(expr->m_env, dt.name() + " is not declared class.");
                         return DataType(TokenType::ERROR);
                     }
 
-                    ClassSig class_sig = find_class_sig(dt.m_lexeme);
+                    ClassSig class_sig = find_class_sig(dt.m_symbol);
 
                     //is field declared? - need to check up inheritance hierarchy
-                    if (!is_declared_field(dt.m_lexeme, expr->m_name.m_lexeme)) {
-                        add_error(expr->m_name, expr->m_name.m_lexeme + " is not a field in " + dt.m_lexeme + ".");
+                    if (!is_declared_field(dt.m_symbol, expr->m_name.m_symbol)) {
+                        add_error(expr->m_name, std::string(expr->m_name.lexeme()) + " is not a field in " + dt.name() + ".");
                         return DataType(TokenType::ERROR);
                     }
 
-                    return get_field_sig(dt.m_lexeme, expr->m_name.m_lexeme);
+                    return get_field_sig(dt.m_symbol, expr->m_name.m_symbol);
                 }
 
 
                 /*
                  *  standard variable
                  */
-                if (!is_declared_var(expr->m_name.m_lexeme)) {
+                if (!is_declared_var(expr->m_name.m_symbol)) {
                     add_error(expr->m_name, "Undefined reference to " + 
                                             expr->m_name.to_string() + ".");
                     return DataType(TokenType::ERROR);
                 }
 
-                return find_var_sig(expr->m_name.m_lexeme);
+                return find_var_sig(expr->m_name.m_symbol);
             }
 
             DataType visit(SetVar* expr) {
@@ -387,32 +464,32 @@ namespace zebra {
                  */
                 if (expr->m_env.m_type != TokenType::NIL) {
                     //is instance declared?
-                    if (!is_declared_var(expr->m_env.m_lexeme)) {
-                        add_error(expr->m_env, expr->m_env.m_lexeme + " is not declared.");
+                    if (!is_declared_var(expr->m_env.m_symbol)) {
+                        add_error(expr->m_env, std::string(expr->m_env.lexeme()) + " is not declared.");
                         return DataType(TokenType::ERROR);
                     }
 
-                    DataType dt = find_var_sig(expr->m_env.m_lexeme);
+                    DataType dt = find_var_sig(expr->m_env.m_symbol);
 
                     //is class declared?
-                    if (!is_declared_class(dt.m_lexeme)) {
-                        add_error(expr->m_env, dt.m_lexeme + " is not declared class.");
+                    if (!is_declared_class(dt.m_symbol)) {
+                        add_error(expr->m_env, dt.name() + " is not declared class.");
                         return DataType(TokenType::ERROR);
                     }
 
-                    ClassSig class_sig = find_class_sig(dt.m_lexeme);
+                    ClassSig class_sig = find_class_sig(dt.m_symbol);
 
                     //is field declared? - need to check up inheritance hierarchy
-                    if (!is_declared_field(dt.m_lexeme, expr->m_name.m_lexeme)) {
-                        add_error(expr->m_name, expr->m_name.m_lexeme + " is not a field in " + dt.m_lexeme + ".");
+                    if (!is_declared_field(dt.m_symbol, expr->m_name.m_symbol)) {
+                        add_error(expr->m_name, std::string(expr->m_name.lexeme()) + " is not a field in " + dt.name() + ".");
                         return DataType(TokenType::ERROR);
                     }
 
-                    DataType field_dt = get_field_sig(dt.m_lexeme, expr->m_name.m_lexeme);
-                    DataType value_dt = evaluate(expr->m_value.get());
+                    DataType field_dt = get_field_sig(dt.m_symbol, expr->m_name.m_symbol);
+                    DataType value_dt = evaluate(expr->m_value);
 
-                    if (!DataType::equal(field_dt, value_dt)) {
-                        add_error(expr->m_name, "'" + expr->m_name.m_lexeme + "' requires a value of type " + Token::to_string(field_dt.m_type) + ".");
+                    if (!is_assignable(field_dt, value_dt)) {
+                        add_error(expr->m_name, "'" + std::string(expr->m_name.lexeme()) + "' requires a value of type " + Token::to_string(field_dt.m_type) + ".");
                         return DataType(TokenType::ERROR);
                     }
 
@@ -423,15 +500,15 @@ namespace zebra {
                  *  standard variable
                  */
 
-                if (!is_declared_var(expr->m_name.m_lexeme)) {
+                if (!is_declared_var(expr->m_name.m_symbol)) {
                     add_error(expr->m_name, "Undefined reference to " + 
                                             expr->m_name.to_string() + ".");
                     return DataType(TokenType::ERROR);
                 }
 
-                DataType var_type = find_var_sig(expr->m_name.m_lexeme);
-                DataType val_type = evaluate(expr->m_value.get());
-                if (!DataType::equal(var_type, val_type)) {
+                DataType var_type = find_var_sig(expr->m_name.m_symbol);
+                DataType val_type = evaluate(expr->m_value);
+                if (!is_assignable(var_type, val_type)) {
                     add_error(expr->m_name, "Cannot assign variable of " + 
                                             Token::to_string(var_type.m_type) + 
                                             " to expression evaluating to " + 
@@ -444,48 +521,15 @@ namespace zebra {
 
             DataType visit(DeclFun* expr) {
                 std::vector<DataType> types;
-                for(std::shared_ptr<Expr> e: expr->m_parameters) {
-                    DeclVar* decl_var = dynamic_cast<DeclVar*>(e.get());
-                    types.push_back(DataType(decl_var->m_type.m_type));
+                for(Expr* e: expr->m_parameters) {
+                    DeclVar* decl_var = expr_cast<DeclVar>(e);
+                    types.push_back(DataType(decl_var->m_type.m_type, type_name(decl_var->m_type)));
                 }
-                types.push_back(DataType(expr->m_return_type));
+                types.push_back(DataType(expr->m_return_type.m_type, type_name(expr->m_return_type)));
 
-                m_fun_sig.back()[expr->m_name.m_lexeme] = types;
+                m_fun_sig.back()[expr->m_name.m_symbol] = types;
 
-                push_scope();
-
-                //declaring parameters in local function scope
-                for(std::shared_ptr<Expr> e: expr->m_parameters) {
-                    DeclVar* decl_var = dynamic_cast<DeclVar*>(e.get());
-                    m_var_sig.back()[decl_var->m_name.m_lexeme] = DataType(decl_var->m_type.m_type);
-                }
-
-                //checking body of function (may be multiple return statements - need to check them all)
-                std::vector<DataType> returns;
-                Block* block = dynamic_cast<Block*>(expr->m_body.get());
-                for (std::shared_ptr<Expr> e: block->m_expressions) {
-                    if (dynamic_cast<Return*>(e.get())) {
-                        returns.push_back(evaluate(e.get()));
-                    } else {
-                        evaluate(e.get());
-                    }
-                }
-
-                pop_scope();
-
-                if (returns.empty()) {
-                    return DataType(TokenType::NIL_TYPE);
-                }
-
-                for (DataType ret: returns) {
-                    if (ret.m_type != expr->m_return_type) {
-                        add_error(expr->m_name, "Return type does not match " + 
-                                                expr->m_name.to_string() +
-                                                " return type, " + 
-                                                Token::to_string(expr->m_return_type) + ".");
-                        return DataType(TokenType::ERROR);
-                    }
-                }
+                check_function(expr);
 
                 return DataType(TokenType::NIL_TYPE);
             }
@@ -497,39 +541,39 @@ namespace zebra {
 
                 if (expr->m_env.m_type != TokenType::NIL) {
                     //is instance declared?
-                    if (!is_declared_var(expr->m_env.m_lexeme)) {
-                        add_error(expr->m_env, "'" + expr->m_env.m_lexeme + "' is not declared.");
+                    if (!is_declared_var(expr->m_env.m_symbol)) {
+                        add_error(expr->m_env, "'" + std::string(expr->m_env.lexeme()) + "' is not declared.");
                         return DataType(TokenType::ERROR);
                     }
 
-                    DataType dt = find_var_sig(expr->m_env.m_lexeme);
+                    DataType dt = find_var_sig(expr->m_env.m_symbol);
 
                     //is class declared?
-                    if (!is_declared_class(dt.m_lexeme)) {
-                        add_error(expr->m_env, "'" + dt.m_lexeme + "' is not declared class.");
+                    if (!is_declared_class(dt.m_symbol)) {
+                        add_error(expr->m_env, "'" + dt.name() + "' is not declared class.");
                         return DataType(TokenType::ERROR);
                     }
 
-                    ClassSig class_sig = find_class_sig(dt.m_lexeme);
+                    ClassSig class_sig = find_class_sig(dt.m_symbol);
 
                     //is method declared? - need to check up inheritance hierarchy
-                    if (!is_declared_method(dt.m_lexeme, expr->m_name.m_lexeme)) {
-                        add_error(expr->m_name, "'" + expr->m_name.m_lexeme + "' is not a method in '" + dt.m_lexeme + "'.");
+                    if (!is_declared_method(dt.m_symbol, expr->m_name.m_symbol)) {
+                        add_error(expr->m_name, "'" + std::string(expr->m_name.lexeme()) + "' is not a method in '" + dt.name() + "'.");
                         return DataType(TokenType::ERROR);
                     }
 
-                    std::vector<DataType> method_sig = get_method_sig(dt.m_lexeme, expr->m_name.m_lexeme);
+                    std::vector<DataType> method_sig = get_method_sig(dt.m_symbol, expr->m_name.m_symbol);
 
-                    if (method_sig.size() - 1 != expr->m_arguments.size()) {
-                        add_error(expr->m_name, "'" + expr->m_name.m_lexeme + "' takes " + std::to_string(method_sig.size() - 1) + " argument(s).");
+                    if (int(method_sig.size()) - 1 != expr->m_arguments.size()) {
+                        add_error(expr->m_name, "'" + std::string(expr->m_name.lexeme()) + "' takes " + std::to_string(method_sig.size() - 1) + " argument(s).");
                         return DataType(TokenType::ERROR);
                     }
 
                     for (int i = 0; i < expr->m_arguments.size(); i++) {
-                        DataType arg_dt = evaluate(expr->m_arguments.at(i).get());
+                        DataType arg_dt = evaluate(expr->m_arguments.at(i));
                         DataType param_dt = method_sig.at(i);
 
-                        if (!DataType::equal(arg_dt, param_dt)) {
+                        if (!is_assignable(param_dt, arg_dt)) {
                             add_error(expr->m_name, "Argument at position " + std::to_string(i) + " must be of type " + Token::to_string(param_dt.m_type) + ".");
                             return DataType(TokenType::ERROR);
                         }
@@ -541,15 +585,15 @@ namespace zebra {
                 /*
                  * Regular Function Call / Class Instantiation
                  */
-                if (!is_declared_fun(expr->m_name.m_lexeme)) {
+                if (!is_declared_fun(expr->m_name.m_symbol)) {
                     add_error(expr->m_name, "Function '" + expr->m_name.to_string() + " not declared.");
                     return DataType(TokenType::ERROR);
                 }
 
-                std::vector<DataType> sig = find_fun_sig(expr->m_name.m_lexeme);
+                std::vector<DataType> sig = find_fun_sig(expr->m_name.m_symbol);
 
                 //function signature includes return type, so it's one size larger than arity
-                if (sig.size() - 1 != expr->m_arguments.size()) {
+                if (int(sig.size()) - 1 != expr->m_arguments.size()) {
                     add_error(expr->m_name, "Number of arguments do no match " + 
                                             expr->m_name.to_string() + " declaration.");
                     return DataType(TokenType::ERROR);
@@ -557,10 +601,10 @@ namespace zebra {
 
                 //check argument types
                 for (int i = 0; i < expr->m_arguments.size(); i++) {
-                    DataType arg_type = evaluate(expr->m_arguments.at(i).get());
+                    DataType arg_type = evaluate(expr->m_arguments.at(i));
                     DataType sig_type = sig.at(i);
                     
-                    if (!DataType::equal(arg_type, sig_type)) {
+                    if (!is_assignable(sig_type, arg_type)) {
                         add_error(expr->m_name, "Argument type at position " + 
                                                 std::to_string(i) + ", " + 
                                                 Token::to_string(arg_type.m_type) + 
@@ -574,11 +618,15 @@ namespace zebra {
             }
 
             DataType visit(Return* expr) {
-                if (expr->m_value) {
-                    return evaluate(expr->m_value.get());
-                } else {
-                    return DataType(TokenType::NIL_TYPE);
+                DataType dt = expr->m_value ? evaluate(expr->m_value) : DataType(TokenType::NIL_TYPE);
+
+                if (!m_return_types.empty() && !is_assignable(m_return_types.back(), dt)) {
+                    add_error(expr->m_name, "Return type does not match function return type, " + 
+                                            Token::to_string(m_return_types.back().m_type) + ".");
+                    return DataType(TokenType::ERROR);
                 }
+
+                return dt;
             }
 
 
@@ -588,8 +636,8 @@ namespace zebra {
 
             DataType visit(Block* expr) {
                 push_scope();
-                for(std::shared_ptr<Expr> e: expr->m_expressions) {
-                    evaluate(e.get());
+                for(Expr* e: expr->m_expressions) {
+                    evaluate(e);
                 }
                 pop_scope();
 
@@ -597,40 +645,40 @@ namespace zebra {
             }
 
             DataType visit(If* expr) {
-                DataType condition = evaluate(expr->m_condition.get());
+                DataType condition = evaluate(expr->m_condition);
                 if (condition.m_type != TokenType::BOOL_TYPE) {
                     add_error(expr->m_name, "If condition cannot evaluate to a " + 
                                             Token::to_string(condition.m_type) + ".");
                     return DataType(TokenType::ERROR);
                 }
-                evaluate(expr->m_then_branch.get());
-                if(expr->m_else_branch) evaluate(expr->m_else_branch.get());
+                evaluate(expr->m_then_branch);
+                if(expr->m_else_branch) evaluate(expr->m_else_branch);
 
                 return DataType(TokenType::NIL_TYPE);
             }
 
             DataType visit(For* expr) {
-                evaluate(expr->m_initializer.get());
-                DataType condition = evaluate(expr->m_condition.get());
-                evaluate(expr->m_update.get());
+                if (expr->m_initializer) evaluate(expr->m_initializer);
+                DataType condition = expr->m_condition ? evaluate(expr->m_condition) : DataType(TokenType::BOOL_TYPE);
+                if (expr->m_update) evaluate(expr->m_update);
                 if (condition.m_type != TokenType::BOOL_TYPE) {
                     add_error(expr->m_name, "For loop condition cannot evaluate to a " + 
                                             Token::to_string(condition.m_type) + ".");
                     return DataType(TokenType::ERROR);
                 }
-                evaluate(expr->m_body.get());
+                evaluate(expr->m_body);
 
                 return DataType(TokenType::NIL_TYPE);
             }
 
             DataType visit(While* expr) {
-                DataType condition = evaluate(expr->m_condition.get());
+                DataType condition = evaluate(expr->m_condition);
                 if (condition.m_type != TokenType::BOOL_TYPE) {
                     add_error(expr->m_name, "For loop condition cannot evaluate to a " + 
                                             Token::to_string(condition.m_type) + ".");
                     return DataType(TokenType::ERROR);
                 }
-                evaluate(expr->m_body.get());
+                evaluate(expr->m_body);
 
                 return DataType(TokenType::NIL_TYPE);
             }
@@ -639,85 +687,30 @@ namespace zebra {
              * Classes
              */
             DataType visit(DeclClass* expr) {
-                /*
-                 * Checking class definition for type errors
-                 */
-
-                bool had_error = false;
-                
-                push_scope(); //class scope
-
-                //declare all fields and check types
-                for (std::shared_ptr<Expr> e: expr->m_fields) {
-                    DataType dt = evaluate(e.get());
-                    DeclVar* decl_var = dynamic_cast<DeclVar*>(e.get());
-                    m_var_sig.back()[decl_var->m_name.m_lexeme] = dt;
-                }
-                
-                for (std::shared_ptr<Expr> m: expr->m_methods) {
-                    DeclFun* method = dynamic_cast<DeclFun*>(m.get());
-                    push_scope(); //class method scope
-
-                    for(std::shared_ptr<Expr> param: method->m_parameters) {
-                        DeclVar* decl_var = dynamic_cast<DeclVar*>(param.get());
-                        m_var_sig.back()[decl_var->m_name.m_lexeme] = DataType(decl_var->m_type.m_type);
-                    }
-
-                    std::vector<DataType> returns;
-                    Block* block = dynamic_cast<Block*>(method->m_body.get());
-                    for (std::shared_ptr<Expr> stmt: block->m_expressions) {
-                        if (dynamic_cast<Return*>(stmt.get())) {
-                            returns.push_back(evaluate(stmt.get()));
-                        } else {
-                            evaluate(stmt.get());
-                        }
-                    }
-
-                    pop_scope(); //class method scope
-
-                    //check return types here
-                    if (returns.empty() && method->m_return_type != TokenType::NIL_TYPE) {
-                        add_error(method->m_name, "Expecting return type of " + Token::to_string(method->m_return_type));
-                        had_error = true;
-                    }
-
-                    for (DataType ret: returns) {
-                        if (ret.m_type != method->m_return_type) {
-                            add_error(method->m_name, "Return type does not match " + 
-                                                    method->m_name.to_string() +
-                                                    " return type, " + 
-                                                    Token::to_string(method->m_return_type) + ".");
-                            had_error = true;
-                        }
-                    }
-                }
-
-                pop_scope(); //class scope
-
-                if (had_error) {
+                if (expr->m_base.m_type != TokenType::NIL && !is_declared_class(expr->m_base.m_symbol)) {
+                    add_error(expr->m_base, "'" + std::string(expr->m_base.lexeme()) + "' is not a declared class.");
                     return DataType(TokenType::ERROR);
                 }
 
                 /*
-                 * Putting class signature into m_class_sig for type checking class instantiations
+                 * Putting class signature into m_class_sig before checking method bodies,
+                 * so methods can refer to the class itself
                  */
 
-                //put fields in field_sig
-                std::unordered_map<std::string, DataType> field_sig;
-                for (std::shared_ptr<Expr> e: expr->m_fields) {
-                    std::string lexeme = dynamic_cast<DeclVar*>(e.get())->m_name.m_lexeme;
-                    DataType dt = evaluate(e.get());
-                    field_sig[lexeme] = dt;
+                std::unordered_map<int, DataType> field_sig;
+                for (Expr* e: expr->m_fields) {
+                    DeclVar* decl_var = expr_cast<DeclVar>(e);
+                    field_sig[decl_var->m_name.m_symbol] = DataType(decl_var->m_type.m_type, type_name(decl_var->m_type));
                 }
                 
-                std::unordered_map<std::string, std::vector<DataType>> method_sig;
+                std::unordered_map<int, std::vector<DataType>> method_sig;
 
-                for (std::shared_ptr<Expr> e: expr->m_methods) {
-                    DeclFun* decl_fun = dynamic_cast<DeclFun*>(e.get());
-                    std::string lexeme = decl_fun->m_name.m_lexeme;
+                for (Expr* e: expr->m_methods) {
+                    DeclFun* decl_fun = expr_cast<DeclFun>(e);
+                    int symbol = decl_fun->m_name.m_symbol;
 
                     //Disallow methods with same name
-                    if (method_sig.count(lexeme) > 0) {
+                    if (method_sig.count(symbol) > 0) {
                         add_error(decl_fun->m_name, "Class method " + decl_fun->m_name.to_string() +
                                                     " already defined.");
                         return DataType(TokenType::ERROR);
@@ -726,24 +719,56 @@ namespace zebra {
                     std::vector<DataType> m_sig;
 
                     //loop through each parameter in method
-                    for (std::shared_ptr<Expr> p: decl_fun->m_parameters) {
-                        DeclVar* decl_var = dynamic_cast<DeclVar*>(p.get());
-                        m_sig.push_back(DataType(decl_var->m_type.m_type)); 
+                    for (Expr* p: decl_fun->m_parameters) {
+                        DeclVar* decl_var = expr_cast<DeclVar>(p);
+                        m_sig.push_back(DataType(decl_var->m_type.m_type, type_name(decl_var->m_type))); 
                     }
 
-                    m_sig.push_back(DataType(decl_fun->m_return_type));
-                    method_sig[lexeme] = m_sig;
+                    m_sig.push_back(DataType(decl_fun->m_return_type.m_type, type_name(decl_fun->m_return_type)));
+                    method_sig[symbol] = m_sig;
                 }
 
-                m_class_sig.back()[expr->m_name.m_lexeme] = {expr->m_base.m_lexeme, field_sig, method_sig};
+                m_class_sig.back()[expr->m_name.m_symbol] = {expr->m_base.m_symbol, field_sig, method_sig};
 
                 /*
                  * Putting constructor function signature in m_fun_sig
                  * 0 parameters for now, with instance return type
                  */
                 std::vector<DataType> types;
-                types.push_back(DataType(TokenType::IDENTIFIER, expr->m_name.m_lexeme));
-                m_fun_sig.back()[expr->m_name.m_lexeme] = types;
+                types.push_back(DataType(TokenType::IDENTIFIER, expr->m_name.m_symbol));
+                m_fun_sig.back()[expr->m_name.m_symbol] = types;
+
+                /*
+                 * Checking class definition for type errors
+                 */
+
+                push_scope(); //class scope
+
+                //inherited members are visible in method bodies, and may be shadowed by this class
+                declare_members(expr->m_base.m_symbol);
+
+                //declare all fields and check types
+                for (Expr* e: expr->m_fields) {
+                    evaluate(e);
+                }
+
+                for (std::pair<int, std::vector<DataType>> p: method_sig) {
+                    m_fun_sig.back()[p.first] = p.second;
+                }
+                
+                //method bodies see the global scope and the class members, the frames the Resolver gives them,
+                //while every class declared so far can still be named as a type
+                std::vector<std::unordered_map<int, DataType>> method_vars {m_var_sig.front(), m_var_sig.back()};
+                std::vector<std::unordered_map<int, std::vector<DataType>>> method_funs {m_fun_sig.front(), m_fun_sig.back()};
+                std::swap(m_var_sig, method_vars);
+                std::swap(m_fun_sig, method_funs);
+                for (Expr* m: expr->m_methods) {
+                    check_function(expr_cast<DeclFun>(m));
+                }
+                std::swap(m_var_sig, method_vars);
+                std::swap(m_fun_sig, method_funs);
+
+                pop_scope(); //class scope
 
                 return DataType(TokenType::NIL_TYPE);
             }
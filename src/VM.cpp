@@ -0,0 +1,357 @@
+#include <cmath>
+#include <climits>
+#include "VM.hpp"
+#include "Object.hpp"
+#include "Library.hpp"
+
+namespace zebra {
+
+    VM::VM() {
+        //natives take the first slots of the global frame, in the order the Resolver declares them
+        m_global = std::make_shared<Environment>();
+        m_environment = m_global;
+
+        std::vector<std::pair<std::string, std::shared_ptr<Callable>>> natives = native_functions();
+        for (int i = 0; i < int(natives.size()); i++) {
+            m_global->define(i, Value(natives.at(i).second));
+        }
+    }
+
+    VM::~VM() {}
+
+    ResultCode VM::run(std::shared_ptr<Chunk> chunk) {
+        m_stack.clear();
+        m_frames.clear();
+        m_frames.push_back({chunk.get(), chunk->m_code.data(), 0, m_environment});
+        return execute();
+    }
+
+    std::vector<RuntimeError> VM::get_errors() const {
+        return m_errors;
+    }
+
+    void VM::add_error(int line, const std::string& message) {
+        m_errors.emplace_back(Token(TokenType::ERROR, nullptr, 0, line), message);
+    }
+
+    void VM::push(Value value) {
+        m_stack.push_back(std::move(value));
+    }
+
+    Value VM::pop() {
+        Value value = std::move(m_stack.back());
+        m_stack.pop_back();
+        return value;
+    }
+
+    ResultCode VM::execute() {
+        CallFrame* frame = &m_frames.back();
+
+        auto read_byte = [&frame]() -> uint8_t {
+            return *frame->m_ip++;
+        };
+
+        auto read_short = [&frame]() -> uint16_t {
+            frame->m_ip += 2;
+            return uint16_t((frame->m_ip[-2] << 8) | frame->m_ip[-1]);
+        };
+
+        auto current_line = [&frame]() -> int {
+            return frame->m_chunk->m_lines.at(frame->m_ip - frame->m_chunk->m_code.data() - 1);
+        };
+
+        for (;;) {
+            switch(OpCode(read_byte())) {
+                case OpCode::CONSTANT:
+                    push(frame->m_chunk->m_constants[read_short()]);
+                    break;
+                case OpCode::NIL: push(Value()); break;
+                case OpCode::TRUE: push(Value(true)); break;
+                case OpCode::FALSE: push(Value(false)); break;
+                case OpCode::POP: m_stack.pop_back(); break;
+
+//operands were checked by the Typer, so typed ops read the payload directly
+#define BINARY_OP(member, op) \
+    do { \
+        Value& left = m_stack[m_stack.size() - 2]; \
+        left = Value(left.member op m_stack.back().member); \
+        m_stack.pop_back(); \
+    } while (false)
+
+//int + - * wrap on overflow, the same results the Optimizer folds to
+#define WRAPPING_OP(op) \
+    do { \
+        Value& left = m_stack[m_stack.size() - 2]; \
+        left = Value(int(unsigned(left.m_int) op unsigned(m_stack.back().m_int))); \
+        m_stack.pop_back(); \
+    } while (false)
+
+                case OpCode::ADD_INT: WRAPPING_OP(+); break;
+                case OpCode::SUBTRACT_INT: WRAPPING_OP(-); break;
+                case OpCode::MULTIPLY_INT: WRAPPING_OP(*); break;
+                case OpCode::DIVIDE_INT:
+                case OpCode::MOD_INT: {
+                    if (m_stack.back().m_int == 0) {
+                        add_error(current_line(), "Integer division by zero.");
+                        return ResultCode::FAILED;
+                    }
+                    if (m_stack.back().m_int == -1 && m_stack[m_stack.size() - 2].m_int == INT_MIN) {
+                        add_error(current_line(), "Integer division overflow.");
+                        return ResultCode::FAILED;
+                    }
+                    if (OpCode(frame->m_ip[-1]) == OpCode::DIVIDE_INT) {
+                        BINARY_OP(m_int, /);
+                    } else {
+                        BINARY_OP(m_int, %);
+                    }
+                    break;
+                }
+                case OpCode::NEGATE_INT: m_stack.back().m_int = int(0u - unsigned(m_stack.back().m_int)); break;
+
+                case OpCode::ADD_FLOAT: BINARY_OP(m_float, +); break;
+                case OpCode::SUBTRACT_FLOAT: BINARY_OP(m_float, -); break;
+                case OpCode::MULTIPLY_FLOAT: BINARY_OP(m_float, *); break;
+                case OpCode::DIVIDE_FLOAT: BINARY_OP(m_float, /); break;
+                case OpCode::NEGATE_FLOAT: m_stack.back().m_float = -m_stack.back().m_float; break;
+
+                case OpCode::CONCAT: {
+                    Value& left = m_stack[m_stack.size() - 2];
+                    left = Value(std::make_shared<String>(left.as_string() + m_stack.back().as_string()));
+                    m_stack.pop_back();
+                    break;
+                }
+                case OpCode::NOT:
+                    m_stack.back().m_bool = !m_stack.back().m_bool;
+                    break;
+
+                case OpCode::EQUAL_INT: BINARY_OP(m_int, ==); break;
+                case OpCode::NOT_EQUAL_INT: BINARY_OP(m_int, !=); break;
+                case OpCode::LESS_INT: BINARY_OP(m_int, <); break;
+                case OpCode::LESS_EQUAL_INT: BINARY_OP(m_int, <=); break;
+                case OpCode::GREATER_INT: BINARY_OP(m_int, >); break;
+                case OpCode::GREATER_EQUAL_INT: BINARY_OP(m_int, >=); break;
+
+                //floats within 0.01 of each other compare as equal
+                case OpCode::EQUAL_FLOAT:
+                case OpCode::NOT_EQUAL_FLOAT:
+                case OpCode::LESS_FLOAT:
+                case OpCode::LESS_EQUAL_FLOAT:
+                case OpCode::GREATER_FLOAT:
+                case OpCode::GREATER_EQUAL_FLOAT: {
+                    Value& left = m_stack[m_stack.size() - 2];
+                    left = Value(compare_float(OpCode(frame->m_ip[-1]), left.m_float, m_stack.back().m_float));
+                    m_stack.pop_back();
+                    break;
+                }
+
+                case OpCode::EQUAL_BOOL: BINARY_OP(m_bool, ==); break;
+                case OpCode::NOT_EQUAL_BOOL: BINARY_OP(m_bool, !=); break;
+
+                case OpCode::EQUAL_STRING:
+                case OpCode::NOT_EQUAL_STRING: {
+                    Value& left = m_stack[m_stack.size() - 2];
+                    bool equal = left.as_string() == m_stack.back().as_string();
+                    left = Value(OpCode(frame->m_ip[-1]) == OpCode::EQUAL_STRING ? equal : !equal);
+                    m_stack.pop_back();
+                    break;
+                }
+#undef BINARY_OP
+#undef WRAPPING_OP
+
+                case OpCode::DEFINE_VAR:
+                    m_environment->define(read_short(), m_stack.back());
+                    break;
+                case OpCode::GET_VAR: {
+                    int depth = read_short();
+                    push(m_environment->get(depth, read_short()));
+                    break;
+                }
+                case OpCode::SET_VAR: {
+                    int depth = read_short();
+                    m_environment->assign(depth, read_short(), m_stack.back());
+                    break;
+                }
+                case OpCode::INCREMENT_INT: {
+                    int depth = read_short();
+                    int slot = read_short();
+                    Value value = m_environment->get(depth, slot);
+                    value.m_int = int(unsigned(value.m_int) + unsigned(frame->m_chunk->m_constants[read_short()].m_int));
+                    m_environment->assign(depth, slot, value);
+                    break;
+                }
+                case OpCode::GET_FIELD: {
+                    int depth = read_short();
+                    ClassInst* inst = m_environment->get(depth, read_short()).as<ClassInst>();
+                    const Token& field_name = frame->m_chunk->m_names[read_short()];
+                    InlineCache& cache = frame->m_chunk->m_caches[read_short()];
+                    push(inst->m_fields->get(inst->m_class->field_slot(field_name.m_symbol, cache)));
+                    break;
+                }
+                case OpCode::SET_FIELD: {
+                    int depth = read_short();
+                    ClassInst* inst = m_environment->get(depth, read_short()).as<ClassInst>();
+                    const Token& field_name = frame->m_chunk->m_names[read_short()];
+                    InlineCache& cache = frame->m_chunk->m_caches[read_short()];
+                    inst->m_fields->define(inst->m_class->field_slot(field_name.m_symbol, cache), m_stack.back());
+                    break;
+                }
+                case OpCode::PUSH_SCOPE:
+                    m_environment = m_env_pool.acquire(m_environment, false, read_short());
+                    break;
+                case OpCode::POP_SCOPE: {
+                    std::shared_ptr<Environment> closure = m_environment->get_closure();
+                    m_env_pool.release(std::move(m_environment));
+                    m_environment = std::move(closure);
+                    break;
+                }
+
+                case OpCode::JUMP: {
+                    uint16_t offset = read_short();
+                    frame->m_ip += offset;
+                    break;
+                }
+                case OpCode::JUMP_IF_FALSE: {
+                    uint16_t offset = read_short();
+                    if (!m_stack.back().m_bool) frame->m_ip += offset;
+                    m_stack.pop_back();
+                    break;
+                }
+                case OpCode::LOOP: {
+                    uint16_t offset = read_short();
+                    frame->m_ip -= offset;
+                    break;
+                }
+
+                case OpCode::CALL: {
+                    //scoping is lexical, so the function closes over the frame its name was declared in
+                    int depth = read_short();
+                    int slot = read_short();
+                    int arg_count = read_short();
+                    std::shared_ptr<Environment> decl_env = m_environment;
+                    for (int i = 0; i < depth; i++) {
+                        decl_env = decl_env->get_closure();
+                    }
+                    if (!call(decl_env->get(slot), arg_count, decl_env, current_line())) {
+                        return ResultCode::FAILED;
+                    }
+                    frame = &m_frames.back();
+                    break;
+                }
+                case OpCode::INVOKE: {
+                    int depth = read_short();
+                    ClassInst* inst = m_environment->get(depth, read_short()).as<ClassInst>();
+                    const Token& method_name = frame->m_chunk->m_names[read_short()];
+                    InlineCache& cache = frame->m_chunk->m_caches[read_short()];
+                    int arg_count = read_short();
+                    //method frame closes over the instance fields
+                    const Value& method = inst->m_class->m_methods->get(inst->m_class->method_slot(method_name.m_symbol, cache));
+                    if (!call(method, arg_count, inst->m_fields, method_name.m_line)) {
+                        return ResultCode::FAILED;
+                    }
+                    frame = &m_frames.back();
+                    break;
+                }
+                case OpCode::RETURN: {
+                    Value result = pop();
+                    //release the call frame along with any block frames still open inside it
+                    while (m_environment != frame->m_caller_env) {
+                        std::shared_ptr<Environment> closure = m_environment->get_closure();
+                        bool is_function = m_environment->is_function();
+                        m_env_pool.release(std::move(m_environment));
+                        m_environment = std::move(closure);
+                        if (is_function) break;
+                    }
+                    m_environment = frame->m_caller_env;
+                    m_stack.resize(frame->m_stack_base);
+                    m_frames.pop_back();
+
+                    if (m_frames.empty()) {
+                        return m_errors.empty() ? ResultCode::SUCCESS : ResultCode::FAILED;
+                    }
+
+                    frame = &m_frames.back();
+                    push(result);
+                    break;
+                }
+                case OpCode::CLASS: {
+                    int slot = read_short();
+                    int base_depth = read_short();
+                    uint16_t base_slot = read_short();
+
+                    int field_count = read_short();
+                    std::vector<std::pair<Token, Value>> fields;
+                    int first_field = int(m_stack.size()) - field_count;
+                    for (int i = 0; i < field_count; i++) {
+                        const Token& field_name = frame->m_chunk->m_names[read_short()];
+                        fields.emplace_back(field_name, m_stack.at(first_field + i));
+                    }
+                    m_stack.resize(first_field);
+
+                    int method_count = read_short();
+                    std::vector<std::pair<Token, Value>> methods;
+                    for (int i = 0; i < method_count; i++) {
+                        const Token& method_name = frame->m_chunk->m_names[read_short()];
+                        methods.emplace_back(method_name, frame->m_chunk->m_constants[read_short()]);
+                    }
+
+                    std::shared_ptr<ClassDef> base = nullptr;
+                    if (base_slot != Chunk::NO_OPERAND) {
+                        base = std::dynamic_pointer_cast<ClassDef>(m_environment->get(base_depth, base_slot).m_object);
+                    }
+
+                    Value class_def = Value(std::make_shared<ClassDef>(base, fields, methods, m_global));
+                    m_environment->define(slot, class_def);
+                    push(class_def);
+                    break;
+                }
+            }
+        }
+    }
+
+    bool VM::call(const Value& callee, int arg_count, std::shared_ptr<Environment> closure, int line) {
+        int first_arg = int(m_stack.size()) - arg_count;
+
+        if (FunDef* fun = callee.as<FunDef>()) {
+            //parameters occupy the first slots of the function frame
+            std::shared_ptr<Environment> fun_env = m_env_pool.acquire(closure, true, fun->m_slot_count);
+            for (int i = 0; i < arg_count; i++) {
+                fun_env->define(i, m_stack.at(first_arg + i));
+            }
+            m_stack.resize(first_arg);
+
+            m_frames.push_back({fun->m_chunk.get(), fun->m_chunk->m_code.data(), first_arg, m_environment});
+            m_environment = std::move(fun_env);
+            return true;
+        }
+
+        if (ClassDef* class_def = callee.as<ClassDef>()) {
+            m_stack.resize(first_arg);
+            push(class_def->instantiate());
+            return true;
+        }
+
+        if (Callable* native = callee.as<Callable>()) {
+            std::vector<Value> arguments(m_stack.begin() + first_arg, m_stack.end());
+            m_stack.resize(first_arg);
+            //native functions never touch the tree-walking interpreter
+            push(native->call(arguments, nullptr));
+            return true;
+        }
+
+        add_error(line, "Can only call functions and classes.");
+        return false;
+    }
+
+    bool VM::compare_float(OpCode op, float a, float b) {
+        switch(op) {
+            case OpCode::EQUAL_FLOAT: return std::abs(a - b) < 0.01f;
+            case OpCode::NOT_EQUAL_FLOAT: return std::abs(a - b) >= 0.01f;
+            case OpCode::LESS_FLOAT: return a < b;
+            case OpCode::LESS_EQUAL_FLOAT: return a < b || std::abs(a - b) < 0.01f;
+            case OpCode::GREATER_FLOAT: return a > b;
+            case OpCode::GREATER_EQUAL_FLOAT: return a > b || std::abs(a - b) < 0.01f;
+            default: return false;
+        }
+    }
+
+}
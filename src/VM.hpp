@@ -0,0 +1,54 @@
+#ifndef ZEBRA_VM_H
+#define ZEBRA_VM_H
+
+#include <vector>
+#include <memory>
+#include "Chunk.hpp"
+#include "Environment.hpp"
+#include "ResultCode.hpp"
+#include "RuntimeError.hpp"
+#include "Value.hpp"
+
+namespace zebra {
+
+    class Object;
+
+    /*
+     * Stack machine executing the bytecode emitted by Compiler.
+     * Variables live in the same Environments used by the tree-walking Interpreter,
+     * while temporaries live on the operand stack.
+     */
+    class VM {
+        private:
+            struct CallFrame {
+                Chunk* m_chunk;
+                const uint8_t* m_ip;
+                int m_stack_base;
+                std::shared_ptr<Environment> m_caller_env;
+            };
+
+            std::vector<Value> m_stack;
+            std::vector<CallFrame> m_frames;
+            std::vector<RuntimeError> m_errors;
+            EnvironmentPool m_env_pool;
+        public:
+            std::shared_ptr<Environment> m_environment;
+            std::shared_ptr<Environment> m_global;
+        public:
+            VM();
+            ~VM();
+            ResultCode run(std::shared_ptr<Chunk> chunk);
+            std::vector<RuntimeError> get_errors() const;
+        private:
+            void add_error(int line, const std::string& message);
+            ResultCode execute();
+            void push(Value value);
+            Value pop();
+            bool call(const Value& callee, int arg_count, std::shared_ptr<Environment> closure, int line);
+            static bool compare_float(OpCode op, float a, float b);
+    };
+
+}
+
+
+#endif //ZEBRA_VM_H
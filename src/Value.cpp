@@ -0,0 +1,12 @@
+#include "Value.hpp"
+#include "Object.hpp"
+
+namespace zebra {
+
+    Value::Value(std::shared_ptr<String> value): m_type(ValueType::STRING), m_int(0), m_object(std::move(value)) {}
+
+    const std::string& Value::as_string() const {
+        return static_cast<String*>(m_object.get())->m_value;
+    }
+
+}
@@ -0,0 +1,62 @@
+#ifndef ZEBRA_VALUE_H
+#define ZEBRA_VALUE_H
+
+#include <string>
+#include <memory>
+#include <cstdint>
+
+namespace zebra {
+
+    class Object;
+    class String;
+
+    enum class ValueType: uint8_t {
+        NIL,
+        BOOL,
+        INT,
+        FLOAT,
+        STRING,     //boxed String
+        OBJECT      //boxed Callable or ClassInst
+    };
+
+    /*
+     * Scalars are stored inline so arithmetic and comparisons never touch the heap.
+     * Only strings, callables and class instances are boxed.
+     */
+    class Value {
+        public:
+            ValueType m_type;
+            union {
+                bool m_bool;
+                int m_int;
+                float m_float;
+            };
+            std::shared_ptr<Object> m_object;
+        public:
+            Value(): m_type(ValueType::NIL), m_int(0) {}
+            explicit Value(bool value): m_type(ValueType::BOOL), m_int(0) { m_bool = value; }
+            explicit Value(int value): m_type(ValueType::INT), m_int(value) {}
+            explicit Value(float value): m_type(ValueType::FLOAT), m_float(value) {}
+            explicit Value(std::shared_ptr<String> value);
+            explicit Value(std::shared_ptr<Object> value): m_type(ValueType::OBJECT), m_int(0), m_object(std::move(value)) {}
+            ~Value() {}
+
+            bool is_nil() const { return m_type == ValueType::NIL; }
+            bool is_bool() const { return m_type == ValueType::BOOL; }
+            bool is_int() const { return m_type == ValueType::INT; }
+            bool is_float() const { return m_type == ValueType::FLOAT; }
+            bool is_string() const { return m_type == ValueType::STRING; }
+            bool is_object() const { return m_type == ValueType::OBJECT; }
+
+            const std::string& as_string() const;
+
+            template <typename T>
+            T* as() const {
+                return dynamic_cast<T*>(m_object.get());
+            }
+    };
+
+}
+
+
+#endif // ZEBRA_VALUE_H